@@ -4,6 +4,38 @@
 #include <iostream>
 #include <cmath>
 #include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <queue>
+#include <limits>
+#include <stdexcept>
+
+// SIMD для пакетной классификации точек (ELLIPSIS_NO_SIMD отключает векторизацию)
+#if !defined(ELLIPSIS_NO_SIMD) && defined(__AVX2__)
+#define ELLIPSIS_SIMD_AVX2
+#include <immintrin.h>
+#elif !defined(ELLIPSIS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ELLIPSIS_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+// Способ вычисления периметра. Относительная ошибка (проверяется в dz01_bench.cpp):
+//                 b/a >= 0.1    любые b/a
+//  RAMANUJAN_I    8.5e-4        4.2e-3
+//  RAMANUJAN_II   1.2e-5        4.0e-4
+//  AGM            1e-15         1e-15
+enum class PerimeterMethod {
+    RAMANUJAN_I,  // pi (3(a + b) - sqrt((3a + b)(a + 3b)))
+    RAMANUJAN_II, // pi (a + b)(1 + 3h / (10 + sqrt(4 - 3h))), h = ((a - b) / (a + b))^2
+    AGM           // полный эллиптический интеграл второго рода через AGM
+};
+
+class CompiledEllipse;
 
 class Ellipsis {
 private:
@@ -39,6 +71,12 @@ public:
         }
     }
     
+    // Геттеры
+    double getH() const { return h; }
+    double getK() const { return k; }
+    double getA() const { return a; }
+    double getB() const { return b; }
+
     // Вычисление гиперпараметра c
     double getC() const {
         return sqrt(a * a - b * b);
@@ -75,16 +113,63 @@ public:
         return ((x - h) * (x - h)) / (a * a) + ((y - k) * (y - k)) / (b * b) <= 1;
     }
 
-    // Приближенный периметр
+    // Приближенный периметр (первая формула Рамануджана)
     double getPerimeter() const {
+        return perimeterRamanujanI(a, b);
+    }
+
+    // Периметр выбранным способом
+    double getPerimeter(PerimeterMethod method) const {
+        switch (method) {
+        case PerimeterMethod::RAMANUJAN_I:
+            return perimeterRamanujanI(a, b);
+        case PerimeterMethod::RAMANUJAN_II:
+            return perimeterRamanujanII(a, b);
+        case PerimeterMethod::AGM:
+            break;
+        }
+        return perimeterAGM(a, b);
+    }
+
+    // Первая формула Рамануджана
+    static double perimeterRamanujanI(double a, double b) {
         return M_PI * (3 * (a + b) - sqrt((3 * a + b) * (a + 3 * b)));
     }
 
+    // Вторая формула Рамануджана
+    static double perimeterRamanujanII(double a, double b) {
+        double t = (a - b) / (a + b);
+        double h3 = 3 * t * t;
+        return M_PI * (a + b) * (1 + h3 / (10 + sqrt(4 - h3)));
+    }
+
+    // Точный периметр: P = 2pi / M(a, b) * (a^2 - sum 2^(n-1) c_n^2),
+    // где M - арифметико-геометрическое среднее, c_0^2 = a^2 - b^2, c_(n+1) = (a_n - b_n) / 2.
+    // Сходится квадратично: 4-6 итераций для умеренных эксцентриситетов.
+    static double perimeterAGM(double a, double b) {
+        if (b <= 0) return 4 * a;
+        double an = a, bn = b;
+        double sum = 0.5 * (a * a - b * b); // 2^(-1) c_0^2
+        double pow2 = 1;                     // 2^(n-1), начиная с n = 1
+        while (an - bn > 1e-15 * an) {
+            double cn = (an - bn) / 2;
+            double next = (an + bn) / 2;
+            bn = sqrt(an * bn);
+            an = next;
+            sum += pow2 * cn * cn;
+            pow2 *= 2;
+        }
+        return 4 * M_PI * (a * a - sum) / (an + bn);
+    }
+
     // Площадь эллипса
     double getArea() const {
         return M_PI * a * b;
     }
 
+    // Неизменяемая копия с заранее вычисленными c, 1/a^2, 1/b^2 и прочими величинами
+    CompiledEllipse compile() const;
+
     // Вычисление второй координаты точки на эллипсе
     double computeSecondCoordinate(double x_or_y, bool isXGiven) const {
         if (isXGiven) {
@@ -95,4 +180,556 @@ public:
     }
 };
 
+// Неизменяемое представление эллипса для горячих циклов. Все величины, которые
+// Ellipsis пересчитывает при каждом вызове (sqrt(a^2 - b^2), деления на a^2 и b^2),
+// вычисляются один раз в конструкторе, так что запросы сводятся к умножениям и сложениям.
+class CompiledEllipse {
+private:
+    double h, k;         // Центр
+    double a, b;         // Полуоси
+    double c;            // sqrt(a^2 - b^2)
+    double invA2, invB2; // 1/a^2 и 1/b^2
+    double a2, b2;       // a^2 и b^2
+    double eccentricity; // c / a
+    double area;         // pi a b
+    double lr;           // 2 b^2 / a
+
+public:
+    explicit CompiledEllipse(const Ellipsis &e)
+        : h(e.getH()), k(e.getK()), a(e.getA()), b(e.getB()), c(e.getC()),
+          invA2(1 / (a * a)), invB2(1 / (b * b)), a2(a * a), b2(b * b),
+          eccentricity(c / a), area(M_PI * a * b), lr(2 * b * b / a) {}
+
+    double getH() const { return h; }
+    double getK() const { return k; }
+    double getA() const { return a; }
+    double getB() const { return b; }
+    double getC() const { return c; }
+    double getInvA2() const { return invA2; }
+    double getInvB2() const { return invB2; }
+    double getEccentricity() const { return eccentricity; }
+    double getArea() const { return area; }
+    double getLR() const { return lr; }
+
+    std::pair<double, double> getVertices() const {
+        return {h - a, h + a};
+    }
+    std::pair<double, double> getFoci() const {
+        return {h - c, h + c};
+    }
+
+    bool isPointInside(double x, double y) const {
+        double dx = x - h, dy = y - k;
+        return dx * dx * invA2 + dy * dy * invB2 <= 1;
+    }
+
+    double computeSecondCoordinate(double x_or_y, bool isXGiven) const {
+        if (isXGiven) {
+            double dx = x_or_y - h;
+            return k + sqrt(b2 - b2 * invA2 * dx * dx);
+        } else {
+            double dy = x_or_y - k;
+            return h + sqrt(a2 - a2 * invB2 * dy * dy);
+        }
+    }
+
+    // Исходный эллипс
+    Ellipsis toEllipsis() const {
+        return Ellipsis(h, k, a, b);
+    }
+};
+
+inline CompiledEllipse Ellipsis::compile() const {
+    return CompiledEllipse(*this);
+}
+
+// Периметры массива эллипсов одним способом: out[i] = es[i].getPerimeter(method).
+// Выбор формулы вынесен из цикла, формулы Рамануджана компилятор векторизует.
+inline void perimeters(const Ellipsis *es, std::size_t n, double *out,
+                       PerimeterMethod method = PerimeterMethod::AGM) {
+    switch (method) {
+    case PerimeterMethod::RAMANUJAN_I:
+        for (std::size_t i = 0; i < n; ++i) out[i] = Ellipsis::perimeterRamanujanI(es[i].getA(), es[i].getB());
+        break;
+    case PerimeterMethod::RAMANUJAN_II:
+        for (std::size_t i = 0; i < n; ++i) out[i] = Ellipsis::perimeterRamanujanII(es[i].getA(), es[i].getB());
+        break;
+    case PerimeterMethod::AGM:
+        for (std::size_t i = 0; i < n; ++i) out[i] = Ellipsis::perimeterAGM(es[i].getA(), es[i].getB());
+        break;
+    }
+}
+
+// Пакетная классификация точек относительно эллипсов.
+//
+// Точки передаются двумя массивами xs и ys. Результат - битовая маска:
+// бит (i % 64) слова mask[i / 64] равен 1, если точка i внутри эллипса.
+// Маска должна вмещать (n + 63) / 64 слов; лишние биты последнего слова нулевые.
+//
+// 1/a^2 и 1/b^2 вычисляются один раз, поэтому сравнение dx^2/a^2 + dy^2/b^2 <= 1
+// идет через умножения. Для точек на расстоянии порядка 1e-16 от границы ответ
+// может отличаться от isPointInside, который делит на a*a и b*b.
+class EllipsisBatch {
+private:
+    // Заполняет слова маски [wordBegin, wordEnd) для точек из [0, n)
+    static void classifyWords(const CompiledEllipse &e, const double *xs, const double *ys, std::size_t n,
+                              std::size_t wordBegin, std::size_t wordEnd, std::uint64_t *mask) {
+        for (std::size_t w = wordBegin; w < wordEnd; ++w) {
+            std::size_t begin = w * 64;
+            std::size_t end = std::min(n, begin + 64);
+            std::uint64_t bits = 0;
+            std::size_t i = begin;
+#if defined(ELLIPSIS_SIMD_AVX2)
+            __m256d h = _mm256_set1_pd(e.getH()), k = _mm256_set1_pd(e.getK());
+            __m256d ia = _mm256_set1_pd(e.getInvA2()), ib = _mm256_set1_pd(e.getInvB2()), one = _mm256_set1_pd(1.0);
+            for (; i + 4 <= end; i += 4) {
+                __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), h);
+                __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), k);
+                __m256d r = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(dx, dx), ia), _mm256_mul_pd(_mm256_mul_pd(dy, dy), ib));
+                bits |= std::uint64_t(_mm256_movemask_pd(_mm256_cmp_pd(r, one, _CMP_LE_OQ))) << (i - begin);
+            }
+#elif defined(ELLIPSIS_SIMD_SSE2)
+            __m128d h = _mm_set1_pd(e.getH()), k = _mm_set1_pd(e.getK());
+            __m128d ia = _mm_set1_pd(e.getInvA2()), ib = _mm_set1_pd(e.getInvB2()), one = _mm_set1_pd(1.0);
+            for (; i + 2 <= end; i += 2) {
+                __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), h);
+                __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), k);
+                __m128d r = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(dx, dx), ia), _mm_mul_pd(_mm_mul_pd(dy, dy), ib));
+                bits |= std::uint64_t(_mm_movemask_pd(_mm_cmple_pd(r, one))) << (i - begin);
+            }
+#endif
+            for (; i < end; ++i) {
+                bits |= std::uint64_t(e.isPointInside(xs[i], ys[i])) << (i - begin);
+            }
+            mask[w] = bits;
+        }
+    }
+
+    // Делит [0, n) на threads кусков и вызывает body(begin, end) в отдельных потоках
+    template <typename Body>
+    static void forRanges(std::size_t n, unsigned threads, Body body) {
+        if (threads <= 1 || n < threads) {
+            body(std::size_t(0), n);
+            return;
+        }
+        std::size_t chunk = (n + threads - 1) / threads;
+        std::vector<std::thread> pool;
+        pool.reserve(threads);
+        for (std::size_t begin = 0; begin < n; begin += chunk) {
+            std::size_t end = std::min(n, begin + chunk);
+            pool.emplace_back([=] { body(begin, end); });
+        }
+        for (auto &t : pool) t.join();
+    }
+
+    // Номер младшего установленного бита (bits != 0)
+    static unsigned lowestBit(std::uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(bits));
+#else
+        unsigned pos = 0;
+        while (!(bits & 1)) {
+            bits >>= 1;
+            ++pos;
+        }
+        return pos;
+#endif
+    }
+
+public:
+    // Количество слов маски для n точек
+    static std::size_t maskWords(std::size_t n) {
+        return (n + 63) / 64;
+    }
+
+    // Классификация n точек относительно одного эллипса
+    static void classify(const Ellipsis &e, const double *xs, const double *ys, std::size_t n,
+                         std::uint64_t *mask, unsigned threads = 1) {
+        CompiledEllipse c = e.compile();
+        forRanges(maskWords(n), threads, [&](std::size_t wordBegin, std::size_t wordEnd) {
+            classifyWords(c, xs, ys, n, wordBegin, wordEnd, mask);
+        });
+    }
+
+    // Классификация n точек относительно m эллипсов: маска эллипса j начинается
+    // с masks[j * maskWords(n)]. Точки обходятся блоками, чтобы блок оставался
+    // в кэше, пока по нему проходят все эллипсы.
+    static void classifyMany(const Ellipsis *es, std::size_t m, const double *xs, const double *ys, std::size_t n,
+                             std::uint64_t *masks, unsigned threads = 1) {
+        const std::size_t blockWords = 64; // 4096 точек, 64 КБ координат
+        std::vector<CompiledEllipse> cs;
+        cs.reserve(m);
+        for (std::size_t j = 0; j < m; ++j) cs.push_back(es[j].compile());
+
+        std::size_t words = maskWords(n);
+        std::size_t blocks = (words + blockWords - 1) / blockWords;
+        forRanges(blocks, threads, [&](std::size_t blockBegin, std::size_t blockEnd) {
+            for (std::size_t blk = blockBegin; blk < blockEnd; ++blk) {
+                std::size_t wordBegin = blk * blockWords;
+                std::size_t wordEnd = std::min(words, wordBegin + blockWords);
+                for (std::size_t j = 0; j < m; ++j) {
+                    classifyWords(cs[j], xs, ys, n, wordBegin, wordEnd, masks + j * words);
+                }
+            }
+        });
+    }
+
+    // Индексы точек, лежащих внутри эллипса (по возрастанию)
+    static std::vector<std::size_t> insideIndices(const Ellipsis &e, const double *xs, const double *ys,
+                                                  std::size_t n, unsigned threads = 1) {
+        std::vector<std::uint64_t> mask(maskWords(n));
+        classify(e, xs, ys, n, mask.data(), threads);
+        return maskToIndices(mask.data(), n);
+    }
+
+    // Перевод битовой маски в список индексов
+    static std::vector<std::size_t> maskToIndices(const std::uint64_t *mask, std::size_t n) {
+        std::vector<std::size_t> result;
+        std::size_t words = maskWords(n);
+        for (std::size_t w = 0; w < words; ++w) {
+            std::uint64_t bits = mask[w];
+            while (bits) {
+                result.push_back(w * 64 + lowestBit(bits));
+                bits &= bits - 1;
+            }
+        }
+        return result;
+    }
+};
+
+// Пространственный индекс эллипсов на равномерной сетке.
+//
+// Каждый эллипс регистрируется во всех ячейках, которые пересекает его
+// ограничивающий прямоугольник [h - a, h + a] x [k - b, k + b]. Запросы
+// просматривают только ячейки рядом с точкой или прямоугольником, поэтому
+// при размере ячейки порядка размера эллипса время не зависит от их числа.
+// Эллипс, которому нужно больше maxCellsPerEllipse ячеек (намного крупнее
+// остальных), в сетку не попадает: он лежит в отдельном списке, который
+// просматривает каждый запрос. Запросы обходят только ячейки внутри границ
+// занятой части сетки, как бы далеко ни была точка или велик прямоугольник.
+// Константные запросы не меняют индекс и могут выполняться из разных потоков.
+class EllipseIndex {
+private:
+    struct Slot {
+        Ellipsis e;
+        CompiledEllipse compiled;
+        bool alive;
+    };
+
+    double cellSize;
+    std::vector<Slot> slots;                                   // Эллипсы по идентификатору
+    std::vector<std::size_t> freeIds;                          // Освобожденные идентификаторы
+    std::unordered_map<std::uint64_t, std::vector<std::size_t> > cells; // Ячейка -> эллипсы
+    std::vector<std::size_t> large;                            // Эллипсы вне сетки
+    std::size_t count;
+    std::size_t gridCount;                                     // Эллипсы в сетке
+    long long minCx, maxCx, minCy, maxCy;                      // Границы занятых ячеек
+
+    long long cellOf(double v) const {
+        return (long long)std::floor(v / cellSize);
+    }
+    // Сдвиг в беззнаковом типе: отрицательные номера ячеек не дают неопределенного поведения
+    static std::uint64_t cellKey(long long cx, long long cy) {
+        return (std::uint64_t(cx) << 32) ^ (std::uint64_t(cy) & 0xffffffffULL);
+    }
+    const std::vector<std::size_t> *cellAt(long long cx, long long cy) const {
+        auto it = cells.find(cellKey(cx, cy));
+        return it == cells.end() ? nullptr : &it->second;
+    }
+
+    // Ячейки ограничивающего прямоугольника эллипса; false - их больше maxCellsPerEllipse
+    bool cellRange(const Ellipsis &e, long long &x0, long long &x1, long long &y0, long long &y1) const {
+        x0 = cellOf(e.getH() - e.getA());
+        x1 = cellOf(e.getH() + e.getA());
+        y0 = cellOf(e.getK() - e.getB());
+        y1 = cellOf(e.getK() + e.getB());
+        return double(x1 - x0 + 1) * double(y1 - y0 + 1) <= double(maxCellsPerEllipse);
+    }
+
+    // Пересекает ли эллипс прямоугольник: после масштабирования осей на 1/a и 1/b
+    // эллипс становится единичным кругом, а прямоугольник остается прямоугольником
+    static bool overlaps(const Slot &s, double xmin, double ymin, double xmax, double ymax) {
+        double h = s.e.getH(), k = s.e.getK();
+        double dx = std::max(xmin - h, std::max(0.0, h - xmax));
+        double dy = std::max(ymin - k, std::max(0.0, k - ymax));
+        return dx * dx * s.compiled.getInvA2() + dy * dy * s.compiled.getInvB2() <= 1;
+    }
+
+    // Корень уравнения для расстояния до эллипса (бисекция, Д. Эберли)
+    static double ellipseRoot(double r0, double z0, double z1, double g) {
+        double n0 = r0 * z0;
+        double s0 = z1 - 1, s1 = g < 0 ? 0 : std::hypot(n0, z1) - 1, s = 0;
+        for (int i = 0; i < 160; ++i) {
+            s = (s0 + s1) / 2;
+            if (s == s0 || s == s1) break;
+            double ratio0 = n0 / (s + r0), ratio1 = z1 / (s + 1);
+            g = ratio0 * ratio0 + ratio1 * ratio1 - 1;
+            if (g > 0) s0 = s;
+            else if (g < 0) s1 = s;
+            else break;
+        }
+        return s;
+    }
+
+public:
+    // Евклидово расстояние от точки до области эллипса (0 для точек внутри)
+    static double distance(const Ellipsis &e, double x, double y) {
+        double e0 = e.getA(), e1 = e.getB();
+        double y0 = std::fabs(x - e.getH()), y1 = std::fabs(y - e.getK());
+        if ((y0 * y0) / (e0 * e0) + (y1 * y1) / (e1 * e1) <= 1) return 0;
+        if (y1 > 0) {
+            if (y0 > 0) {
+                double z0 = y0 / e0, z1 = y1 / e1;
+                double r0 = (e0 / e1) * (e0 / e1);
+                double sbar = ellipseRoot(r0, z0, z1, z0 * z0 + z1 * z1 - 1);
+                double x0 = r0 * y0 / (sbar + r0), x1 = y1 / (sbar + 1);
+                return std::hypot(x0 - y0, x1 - y1);
+            }
+            return y1 - e1;
+        }
+        double numer0 = e0 * y0, denom0 = e0 * e0 - e1 * e1;
+        if (numer0 < denom0) {
+            double xde0 = numer0 / denom0;
+            double x0 = e0 * xde0, x1 = e1 * std::sqrt(1 - xde0 * xde0);
+            return std::hypot(x0 - y0, x1);
+        }
+        return y0 - e0;
+    }
+
+    // Больше ячеек на эллипс - и он уходит в список крупных
+    static const std::size_t maxCellsPerEllipse = 64;
+
+    // Конструкторы: размер ячейки задается явно или подбирается по среднему размеру эллипсов
+    explicit EllipseIndex(double cellSize = 1.0)
+        : cellSize(cellSize), count(0), gridCount(0), minCx(0), maxCx(-1), minCy(0), maxCy(-1) {
+        if (!(cellSize > 0)) {
+            throw std::invalid_argument("Размер ячейки должен быть положительным");
+        }
+    }
+    explicit EllipseIndex(const std::vector<Ellipsis> &ellipses)
+        : EllipseIndex(suggestCellSize(ellipses)) {
+        slots.reserve(ellipses.size());
+        for (const auto &e : ellipses) insert(e);
+    }
+
+    // Размер ячейки: средняя ширина ограничивающего прямоугольника
+    static double suggestCellSize(const std::vector<Ellipsis> &ellipses) {
+        if (ellipses.empty()) return 1.0;
+        double sum = 0;
+        for (const auto &e : ellipses) sum += 2 * e.getA();
+        return std::max(sum / ellipses.size(), 1e-9);
+    }
+
+    std::size_t size() const { return count; }
+    // Эллипсов в списке крупных (вне сетки)
+    std::size_t largeCount() const { return large.size(); }
+
+    // Эллипс по идентификатору
+    const Ellipsis &get(std::size_t id) const {
+        if (id >= slots.size() || !slots[id].alive) {
+            throw std::out_of_range("Нет эллипса с таким идентификатором");
+        }
+        return slots[id].e;
+    }
+
+    // Добавление эллипса, возвращает его идентификатор
+    std::size_t insert(const Ellipsis &e) {
+        std::size_t id;
+        if (!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+        } else {
+            id = slots.size();
+            slots.push_back(Slot{e, e.compile(), false});
+        }
+        slots[id] = Slot{e, e.compile(), true};
+        ++count;
+
+        long long x0, x1, y0, y1;
+        if (!cellRange(e, x0, x1, y0, y1)) {
+            large.push_back(id);
+            return id;
+        }
+        for (long long cx = x0; cx <= x1; ++cx)
+            for (long long cy = y0; cy <= y1; ++cy) cells[cellKey(cx, cy)].push_back(id);
+
+        if (gridCount == 0) {
+            minCx = x0; maxCx = x1; minCy = y0; maxCy = y1;
+        } else {
+            minCx = std::min(minCx, x0); maxCx = std::max(maxCx, x1);
+            minCy = std::min(minCy, y0); maxCy = std::max(maxCy, y1);
+        }
+        ++gridCount;
+        return id;
+    }
+
+    // Удаление эллипса по идентификатору
+    bool remove(std::size_t id) {
+        if (id >= slots.size() || !slots[id].alive) return false;
+        const Ellipsis &e = slots[id].e;
+        long long x0, x1, y0, y1;
+        if (!cellRange(e, x0, x1, y0, y1)) {
+            auto pos = std::find(large.begin(), large.end(), id);
+            *pos = large.back();
+            large.pop_back();
+            slots[id].alive = false;
+            freeIds.push_back(id);
+            --count;
+            return true;
+        }
+        for (long long cx = x0; cx <= x1; ++cx) {
+            for (long long cy = y0; cy <= y1; ++cy) {
+                auto it = cells.find(cellKey(cx, cy));
+                std::vector<std::size_t> &ids = it->second;
+                auto pos = std::find(ids.begin(), ids.end(), id);
+                *pos = ids.back();
+                ids.pop_back();
+                if (ids.empty()) cells.erase(it);
+            }
+        }
+        slots[id].alive = false;
+        freeIds.push_back(id);
+        --count;
+        --gridCount;
+        return true;
+    }
+
+    // Идентификаторы эллипсов, содержащих точку
+    std::vector<std::size_t> containing(double x, double y) const {
+        std::vector<std::size_t> result;
+        for (std::size_t id : large) {
+            if (slots[id].compiled.isPointInside(x, y)) result.push_back(id);
+        }
+        const std::vector<std::size_t> *ids = cellAt(cellOf(x), cellOf(y));
+        if (!ids) return result;
+        for (std::size_t id : *ids) {
+            if (slots[id].compiled.isPointInside(x, y)) result.push_back(id);
+        }
+        return result;
+    }
+
+    // Идентификаторы эллипсов, пересекающих прямоугольник [xmin, xmax] x [ymin, ymax].
+    // Эллипс, попавший в несколько ячеек, сообщается один раз: только в ячейке,
+    // где лежит левый нижний угол пересечения прямоугольников.
+    std::vector<std::size_t> overlapping(double xmin, double ymin, double xmax, double ymax) const {
+        std::vector<std::size_t> result;
+        for (std::size_t id : large) {
+            if (overlaps(slots[id], xmin, ymin, xmax, ymax)) result.push_back(id);
+        }
+        if (gridCount == 0) return result;
+        // Ячейки вне границ занятой части пусты
+        long long x0 = std::max(cellOf(xmin), minCx), x1 = std::min(cellOf(xmax), maxCx);
+        long long y0 = std::max(cellOf(ymin), minCy), y1 = std::min(cellOf(ymax), maxCy);
+        for (long long cx = x0; cx <= x1; ++cx) {
+            for (long long cy = y0; cy <= y1; ++cy) {
+                const std::vector<std::size_t> *ids = cellAt(cx, cy);
+                if (!ids) continue;
+                for (std::size_t id : *ids) {
+                    const Ellipsis &e = slots[id].e;
+                    if (cellOf(std::max(xmin, e.getH() - e.getA())) != cx ||
+                        cellOf(std::max(ymin, e.getK() - e.getB())) != cy) continue;
+                    if (overlaps(slots[id], xmin, ymin, xmax, ymax)) result.push_back(id);
+                }
+            }
+        }
+        return result;
+    }
+
+    // k ближайших к точке эллипсов (расстояние до области, 0 внутри), по возрастанию расстояния.
+    // Ячейки обходятся кольцами; после кольца r все эллипсы ближе r * cellSize уже найдены.
+    // Кольца обрезаются границами занятых ячеек, а для точки вдали от них обход
+    // начинается с первого кольца, задевающего эти границы.
+    std::vector<std::pair<double, std::size_t> > nearest(double x, double y, std::size_t k) const {
+        std::vector<std::pair<double, std::size_t> > heap; // max-куча по расстоянию
+        if (k == 0 || count == 0) return heap;
+        std::unordered_set<std::size_t> seen;
+        long long px = cellOf(x), py = cellOf(y);
+        long long minRing = std::max({minCx - px, px - maxCx, minCy - py, py - maxCy, 0LL});
+        long long maxRing = std::max({px - minCx, maxCx - px, py - minCy, maxCy - py, 0LL});
+
+        auto consider = [&](std::size_t id) {
+            const Ellipsis &e = slots[id].e;
+            if (heap.size() == k) {
+                // Расстояние до прямоугольника - нижняя оценка, точный расчет дорогой
+                double bx = std::max(std::fabs(x - e.getH()) - e.getA(), 0.0);
+                double by = std::max(std::fabs(y - e.getK()) - e.getB(), 0.0);
+                if (bx * bx + by * by >= heap.front().first * heap.front().first) return;
+            }
+            double d = distance(e, x, y);
+            if (heap.size() < k) {
+                heap.push_back({d, id});
+                std::push_heap(heap.begin(), heap.end());
+            } else if (d < heap.front().first) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = {d, id};
+                std::push_heap(heap.begin(), heap.end());
+            }
+        };
+        auto visit = [&](long long cx, long long cy) {
+            const std::vector<std::size_t> *ids = cellAt(cx, cy);
+            if (!ids) return;
+            for (std::size_t id : *ids) {
+                if (seen.insert(id).second) consider(id);
+            }
+        };
+
+        for (std::size_t id : large) consider(id);
+        if (gridCount == 0) maxRing = -1;
+
+        for (long long r = minRing; r <= maxRing; ++r) {
+            if (r == 0) {
+                visit(px, py);
+            } else {
+                long long cx0 = std::max(px - r, minCx), cx1 = std::min(px + r, maxCx);
+                long long cy0 = std::max(py - r + 1, minCy), cy1 = std::min(py + r - 1, maxCy);
+                for (long long cx = cx0; cx <= cx1; ++cx) {
+                    if (py - r >= minCy) visit(cx, py - r);
+                    if (py + r <= maxCy) visit(cx, py + r);
+                }
+                for (long long cy = cy0; cy <= cy1; ++cy) {
+                    if (px - r >= minCx) visit(px - r, cy);
+                    if (px + r <= maxCx) visit(px + r, cy);
+                }
+            }
+            if (heap.size() == k && heap.front().first <= r * cellSize) break;
+        }
+        std::sort_heap(heap.begin(), heap.end());
+        return heap;
+    }
+
+    // Пакетные запросы: точка i обрабатывается независимо, потоки делят точки поровну
+    std::vector<std::vector<std::size_t> > containingBatch(const double *xs, const double *ys, std::size_t n,
+                                                           unsigned threads = 1) const {
+        std::vector<std::vector<std::size_t> > result(n);
+        runBatch(n, threads, [&](std::size_t i) { result[i] = containing(xs[i], ys[i]); });
+        return result;
+    }
+
+    std::vector<std::vector<std::pair<double, std::size_t> > > nearestBatch(const double *xs, const double *ys,
+                                                                            std::size_t n, std::size_t k,
+                                                                            unsigned threads = 1) const {
+        std::vector<std::vector<std::pair<double, std::size_t> > > result(n);
+        runBatch(n, threads, [&](std::size_t i) { result[i] = nearest(xs[i], ys[i], k); });
+        return result;
+    }
+
+private:
+    template <typename Fn>
+    static void runBatch(std::size_t n, unsigned threads, Fn fn) {
+        if (threads <= 1 || n < threads) {
+            for (std::size_t i = 0; i < n; ++i) fn(i);
+            return;
+        }
+        std::size_t chunk = (n + threads - 1) / threads;
+        std::vector<std::thread> pool;
+        for (std::size_t begin = 0; begin < n; begin += chunk) {
+            std::size_t end = std::min(n, begin + chunk);
+            pool.emplace_back([=] {
+                for (std::size_t i = begin; i < end; ++i) fn(i);
+            });
+        }
+        for (auto &t : pool) t.join();
+    }
+};
+
 #endif
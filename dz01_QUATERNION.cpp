@@ -3,28 +3,73 @@
 
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <limits>
+#include <type_traits>
 
+// Выбор набора SIMD-инструкций для пакетных ядер (QUATERNION_NO_SIMD отключает векторизацию)
+#if !defined(QUATERNION_NO_SIMD) && defined(__AVX2__)
+#define QUATERNION_SIMD_AVX2
+#include <immintrin.h>
+#elif !defined(QUATERNION_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define QUATERNION_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+// Трехмерный вектор (точка)
+template <typename T>
+struct Vec3 {
+    T x, y, z;
+};
+
+// Матрица 3x3, m[строка][столбец]
+template <typename T>
+struct Matrix3 {
+    T m[3][3];
+};
+
+// Кватернион a + bi + cj + dk с компонентами типа T (float, double или long double).
+// Тип тривиально копируемый и состоит ровно из четырех T подряд, поэтому массивы
+// кватернионов можно копировать через memcpy и отображать из файлов.
+template <typename T>
 class Quaternion {
+    static_assert(std::is_floating_point<T>::value, "Quaternion<T>: T должен быть вещественным типом");
+
 private:
-    double a, b, c, d; // Коэффициенты кватерниона (a + bi + cj + dk)
+    T a, b, c, d; // Коэффициенты кватерниона (a + bi + cj + dk)
+
+    static constexpr T absValue(T x) noexcept { return x < 0 ? -x : x; }
 
 public:
+    typedef T value_type;
+
     // Конструкторы
-    Quaternion() : a(1), b(0), c(0), d(0) {}
-    Quaternion(double a, double b, double c, double d) : a(a), b(b), c(c), d(d) {}
-    Quaternion(const Quaternion &q) : a(q.a), b(q.b), c(q.c), d(q.d) {}
+    constexpr Quaternion() noexcept : a(1), b(0), c(0), d(0) {}
+    constexpr Quaternion(T a, T b, T c, T d) noexcept : a(a), b(b), c(c), d(d) {}
+    Quaternion(const Quaternion &q) = default;
+    Quaternion &operator=(const Quaternion &q) = default;
+
+    // Преобразование точности (например, Quaternion<double> -> Quaternion<float>)
+    template <typename U>
+    constexpr explicit Quaternion(const Quaternion<U> &q) noexcept
+        : a(T(q.getA())), b(T(q.getB())), c(T(q.getC())), d(T(q.getD())) {}
 
     // Сеттеры и геттеры
-    void setValues(double a, double b, double c, double d) {
+    constexpr void setValues(T a, T b, T c, T d) noexcept {
         this->a = a;
         this->b = b;
         this->c = c;
         this->d = d;
     }
-    double getA() const { return a; }
-    double getB() const { return b; }
-    double getC() const { return c; }
-    double getD() const { return d; }
+    constexpr T getA() const noexcept { return a; }
+    constexpr T getB() const noexcept { return b; }
+    constexpr T getC() const noexcept { return c; }
+    constexpr T getD() const noexcept { return d; }
 
     // Вывод кватерниона
     void printQuaternion() const {
@@ -32,35 +77,35 @@ public:
     }
 
     // Вычисление нормы
-    double norm() const {
-        return sqrt(a * a + b * b + c * c + d * d);
+    T norm() const {
+        return std::sqrt(a * a + b * b + c * c + d * d);
     }
 
     // Сопряженный кватернион
-    Quaternion conjugate() const {
+    constexpr Quaternion conjugate() const noexcept {
         return Quaternion(a, -b, -c, -d);
     }
 
     // Нормализация
     Quaternion normalize() const {
-        double n = norm();
+        T n = norm();
         return Quaternion(a / n, b / n, c / n, d / n);
     }
 
     // Инверсия
     Quaternion inverse() const {
-        double n2 = norm() * norm();
+        T n2 = norm() * norm();
         return conjugate() * (1 / n2);
     }
 
     // Операции над кватернионами
-    Quaternion operator+(const Quaternion &q) const {
+    constexpr Quaternion operator+(const Quaternion &q) const noexcept {
         return Quaternion(a + q.a, b + q.b, c + q.c, d + q.d);
     }
-    Quaternion operator-(const Quaternion &q) const {
+    constexpr Quaternion operator-(const Quaternion &q) const noexcept {
         return Quaternion(a - q.a, b - q.b, c - q.c, d - q.d);
     }
-    Quaternion operator*(const Quaternion &q) const {
+    constexpr Quaternion operator*(const Quaternion &q) const noexcept {
         return Quaternion(
             a * q.a - b * q.b - c * q.c - d * q.d,
             a * q.b + b * q.a + c * q.d - d * q.c,
@@ -68,23 +113,679 @@ public:
             a * q.d + b * q.c - c * q.b + d * q.a
         );
     }
+    constexpr Quaternion operator*(T s) const noexcept {
+        return Quaternion(a * s, b * s, c * s, d * s);
+    }
     Quaternion operator/(const Quaternion &q) const {
         return (*this) * q.inverse();
     }
 
     // Скалярное произведение
-    double dotProduct(const Quaternion &q) const {
+    constexpr T dotProduct(const Quaternion &q) const noexcept {
         return a * q.a + b * q.b + c * q.c + d * q.d;
     }
 
     // Евклидово расстояние
-    double euclideanDistance(const Quaternion &q) const {
-        return sqrt(pow(a - q.a, 2) + pow(b - q.b, 2) + pow(c - q.c, 2) + pow(d - q.d, 2));
+    T euclideanDistance(const Quaternion &q) const {
+        return std::sqrt(std::pow(a - q.a, 2) + std::pow(b - q.b, 2) + std::pow(c - q.c, 2) + std::pow(d - q.d, 2));
     }
 
     // Норма Чебышева
-    double chebyshevNorm(const Quaternion &q) const {
-        return std::max({fabs(a - q.a), fabs(b - q.b), fabs(c - q.c), fabs(d - q.d)});
+    constexpr T chebyshevNorm(const Quaternion &q) const noexcept {
+        return std::max({absValue(a - q.a), absValue(b - q.b), absValue(c - q.c), absValue(d - q.d)});
+    }
+
+    // Логарифм кватерниона
+    Quaternion log() const {
+        T n = norm();
+        T vn = std::sqrt(b * b + c * c + d * d);
+        if (vn < std::numeric_limits<T>::min()) {
+            return Quaternion(std::log(n), 0, 0, 0);
+        }
+        T k = std::acos(std::max(T(-1), std::min(T(1), a / n))) / vn;
+        return Quaternion(std::log(n), b * k, c * k, d * k);
+    }
+
+    // Экспонента кватерниона
+    Quaternion exp() const {
+        T ea = std::exp(a);
+        T vn = std::sqrt(b * b + c * c + d * d);
+        if (vn < std::numeric_limits<T>::min()) {
+            return Quaternion(ea, 0, 0, 0);
+        }
+        T k = ea * std::sin(vn) / vn;
+        return Quaternion(ea * std::cos(vn), b * k, c * k, d * k);
+    }
+
+    // Поворот вектора единичным кватернионом: то же, что q * p * q.inverse(), но без
+    // двух произведений Гамильтона и sqrt (v' = v + a*t + u x t, где t = 2 u x v)
+    constexpr Vec3<T> rotate(const Vec3<T> &v) const noexcept {
+        T tx = 2 * (c * v.z - d * v.y);
+        T ty = 2 * (d * v.x - b * v.z);
+        T tz = 2 * (b * v.y - c * v.x);
+        return Vec3<T>{v.x + a * tx + (c * tz - d * ty),
+                       v.y + a * ty + (d * tx - b * tz),
+                       v.z + a * tz + (b * ty - c * tx)};
+    }
+
+    // Матрица поворота единичного кватерниона
+    constexpr Matrix3<T> toRotationMatrix() const noexcept {
+        T bb = b * b, cc = c * c, dd = d * d;
+        T bc = b * c, bd = b * d, cd = c * d;
+        T ab = a * b, ac = a * c, ad = a * d;
+        return Matrix3<T>{{{1 - 2 * (cc + dd), 2 * (bc - ad), 2 * (bd + ac)},
+                           {2 * (bc + ad), 1 - 2 * (bb + dd), 2 * (cd - ab)},
+                           {2 * (bd - ac), 2 * (cd + ab), 1 - 2 * (bb + cc)}}};
+    }
+
+    // Единичный кватернион по матрице поворота (метод Шеппарда: делим на
+    // наибольший из диагональных вариантов, чтобы не терять точность)
+    static Quaternion fromRotationMatrix(const Matrix3<T> &r) {
+        const T (*m)[3] = r.m;
+        T trace = m[0][0] + m[1][1] + m[2][2];
+        if (trace > 0) {
+            T s = 2 * std::sqrt(trace + 1);
+            return Quaternion(s / 4, (m[2][1] - m[1][2]) / s, (m[0][2] - m[2][0]) / s, (m[1][0] - m[0][1]) / s);
+        }
+        if (m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+            T s = 2 * std::sqrt(1 + m[0][0] - m[1][1] - m[2][2]);
+            return Quaternion((m[2][1] - m[1][2]) / s, s / 4, (m[0][1] + m[1][0]) / s, (m[0][2] + m[2][0]) / s);
+        }
+        if (m[1][1] > m[2][2]) {
+            T s = 2 * std::sqrt(1 + m[1][1] - m[0][0] - m[2][2]);
+            return Quaternion((m[0][2] - m[2][0]) / s, (m[0][1] + m[1][0]) / s, s / 4, (m[1][2] + m[2][1]) / s);
+        }
+        T s = 2 * std::sqrt(1 + m[2][2] - m[0][0] - m[1][1]);
+        return Quaternion((m[1][0] - m[0][1]) / s, (m[0][2] + m[2][0]) / s, (m[1][2] + m[2][1]) / s, s / 4);
+    }
+};
+
+typedef Quaternion<float> Quaternionf;
+typedef Quaternion<double> Quaterniond;
+typedef Quaternion<long double> Quaternionl;
+typedef Vec3<float> Vec3f;
+typedef Vec3<double> Vec3d;
+typedef Matrix3<double> Matrix3d;
+
+// Раскладка: ровно четыре компоненты без заполнителей, копирование побайтовое
+static_assert(std::is_trivially_copyable<Quaternionf>::value && std::is_standard_layout<Quaternionf>::value &&
+              sizeof(Quaternionf) == 4 * sizeof(float), "Quaternion<float>: нарушена раскладка");
+static_assert(std::is_trivially_copyable<Quaterniond>::value && std::is_standard_layout<Quaterniond>::value &&
+              sizeof(Quaterniond) == 4 * sizeof(double), "Quaternion<double>: нарушена раскладка");
+static_assert(std::is_trivially_copyable<Quaternionl>::value && std::is_standard_layout<Quaternionl>::value &&
+              sizeof(Quaternionl) == 4 * sizeof(long double), "Quaternion<long double>: нарушена раскладка");
+
+// Проверка constexpr-арифметики на этапе компиляции
+static_assert((Quaterniond(0, 1, 0, 0) * Quaterniond(0, 0, 1, 0)).getD() == 1, "i * j = k");
+static_assert(Quaterniond(1, 2, 3, 4).conjugate().dotProduct(Quaterniond(1, 0, 0, 0)) == 1, "conjugate/dot");
+static_assert(Quaternionf(1, 2, 3, 4).chebyshevNorm(Quaternionf(1, 0, 3, 8)) == 4, "chebyshevNorm");
+
+// Аллокатор с выравниванием по 32 байтам для SoA-массивов
+template <typename T>
+struct AlignedAllocator {
+    typedef T value_type;
+    static const std::size_t alignment = 32;
+
+    AlignedAllocator() = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U> &) {}
+
+    T *allocate(std::size_t n) {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+    }
+    void deallocate(T *p, std::size_t) {
+        ::operator delete(p, std::align_val_t(alignment));
+    }
+
+    template <typename U> bool operator==(const AlignedAllocator<U> &) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U> &) const { return false; }
+};
+
+// Тонкая обертка над SIMD-регистром: одни и те же ядра собираются под AVX2, SSE2 и скаляр
+namespace qsimd {
+#if defined(QUATERNION_SIMD_AVX2)
+    typedef __m256d Vec;
+    const std::size_t lanes = 4;
+    inline Vec load(const double *p) { return _mm256_load_pd(p); }
+    inline void store(double *p, Vec v) { _mm256_store_pd(p, v); }
+    inline Vec loadu(const double *p) { return _mm256_loadu_pd(p); }
+    inline void storeu(double *p, Vec v) { _mm256_storeu_pd(p, v); }
+    inline Vec set1(double x) { return _mm256_set1_pd(x); }
+    inline Vec add(Vec x, Vec y) { return _mm256_add_pd(x, y); }
+    inline Vec sub(Vec x, Vec y) { return _mm256_sub_pd(x, y); }
+    inline Vec mul(Vec x, Vec y) { return _mm256_mul_pd(x, y); }
+    inline Vec div(Vec x, Vec y) { return _mm256_div_pd(x, y); }
+    inline Vec sqrt(Vec x) { return _mm256_sqrt_pd(x); }
+    inline Vec neg(Vec x) { return _mm256_xor_pd(x, _mm256_set1_pd(-0.0)); }
+#elif defined(QUATERNION_SIMD_SSE2)
+    typedef __m128d Vec;
+    const std::size_t lanes = 2;
+    inline Vec load(const double *p) { return _mm_load_pd(p); }
+    inline void store(double *p, Vec v) { _mm_store_pd(p, v); }
+    inline Vec loadu(const double *p) { return _mm_loadu_pd(p); }
+    inline void storeu(double *p, Vec v) { _mm_storeu_pd(p, v); }
+    inline Vec set1(double x) { return _mm_set1_pd(x); }
+    inline Vec add(Vec x, Vec y) { return _mm_add_pd(x, y); }
+    inline Vec sub(Vec x, Vec y) { return _mm_sub_pd(x, y); }
+    inline Vec mul(Vec x, Vec y) { return _mm_mul_pd(x, y); }
+    inline Vec div(Vec x, Vec y) { return _mm_div_pd(x, y); }
+    inline Vec sqrt(Vec x) { return _mm_sqrt_pd(x); }
+    inline Vec neg(Vec x) { return _mm_xor_pd(x, _mm_set1_pd(-0.0)); }
+#else
+    typedef double Vec;
+    const std::size_t lanes = 1;
+    inline Vec load(const double *p) { return *p; }
+    inline void store(double *p, Vec v) { *p = v; }
+    inline Vec loadu(const double *p) { return *p; }
+    inline void storeu(double *p, Vec v) { *p = v; }
+    inline Vec set1(double x) { return x; }
+    inline Vec add(Vec x, Vec y) { return x + y; }
+    inline Vec sub(Vec x, Vec y) { return x - y; }
+    inline Vec mul(Vec x, Vec y) { return x * y; }
+    inline Vec div(Vec x, Vec y) { return x / y; }
+    inline Vec sqrt(Vec x) { return std::sqrt(x); }
+    inline Vec neg(Vec x) { return -x; }
+#endif
+}
+
+// Пакет кватернионов в SoA-раскладке: a, b, c и d лежат в четырех выровненных массивах.
+//
+// Точность: ядра повторяют порядок операций скалярного класса Quaternion<double>
+// (умножение, сложение и sqrt/деление по IEEE 754 без FMA), поэтому результат
+// совпадает с ним побитно (0 ULP). Если компилятор сам сжимает скалярный код
+// в FMA (-ffp-contract=fast, /fp:fast), расхождение multiply и dot не превышает
+// 4 ULP от суммы модулей слагаемых, normalize и inverse - 2 ULP на компоненту.
+class QuaternionBatch {
+private:
+    typedef std::vector<double, AlignedAllocator<double> > Column;
+
+    std::size_t count; // Количество кватернионов
+    Column a, b, c, d; // Компоненты, длина дополнена до кратной qsimd::lanes
+
+    static std::size_t padded(std::size_t n) {
+        return (n + qsimd::lanes - 1) / qsimd::lanes * qsimd::lanes;
+    }
+
+    void checkSize(const QuaternionBatch &other) const {
+        if (other.count != count) {
+            throw std::invalid_argument("Пакеты кватернионов должны быть одинакового размера");
+        }
+    }
+
+public:
+    // Конструкторы
+    QuaternionBatch() : count(0) {}
+    explicit QuaternionBatch(std::size_t n) : count(0) { resize(n); }
+    QuaternionBatch(const Quaterniond *qs, std::size_t n) : count(0) {
+        resize(n);
+        for (std::size_t i = 0; i < n; ++i) set(i, qs[i]);
+    }
+
+    // Размер пакета; новые элементы инициализируются единичным кватернионом
+    std::size_t size() const { return count; }
+
+    void resize(std::size_t n) {
+        std::size_t p = padded(n);
+        a.resize(p, 0.0);
+        b.resize(p, 0.0);
+        c.resize(p, 0.0);
+        d.resize(p, 0.0);
+        for (std::size_t i = count; i < n; ++i) {
+            a[i] = 1; b[i] = 0; c[i] = 0; d[i] = 0;
+        }
+        // Хвост заполняем единичными кватернионами, чтобы normalize/inverse не делили на ноль
+        for (std::size_t i = n; i < p; ++i) {
+            a[i] = 1; b[i] = 0; c[i] = 0; d[i] = 0;
+        }
+        count = n;
+    }
+
+    void reserve(std::size_t n) {
+        std::size_t p = padded(n);
+        a.reserve(p);
+        b.reserve(p);
+        c.reserve(p);
+        d.reserve(p);
+    }
+
+    void push_back(const Quaterniond &q) {
+        resize(count + 1);
+        set(count - 1, q);
+    }
+
+    // Доступ к элементам
+    Quaterniond get(std::size_t i) const {
+        return Quaterniond(a[i], b[i], c[i], d[i]);
+    }
+    void set(std::size_t i, const Quaterniond &q) {
+        a[i] = q.getA();
+        b[i] = q.getB();
+        c[i] = q.getC();
+        d[i] = q.getD();
+    }
+
+    // Прямой доступ к столбцам
+    const double *dataA() const { return a.data(); }
+    const double *dataB() const { return b.data(); }
+    const double *dataC() const { return c.data(); }
+    const double *dataD() const { return d.data(); }
+    double *dataA() { return a.data(); }
+    double *dataB() { return b.data(); }
+    double *dataC() { return c.data(); }
+    double *dataD() { return d.data(); }
+
+    // Поэлементное произведение Гамильтона: out[i] = x[i] * y[i] (out может совпадать с x или y)
+    static void multiply(const QuaternionBatch &x, const QuaternionBatch &y, QuaternionBatch &out) {
+        x.checkSize(y);
+        if (out.count != x.count) out.resize(x.count);
+        std::size_t n = padded(x.count);
+        for (std::size_t i = 0; i < n; i += qsimd::lanes) {
+            qsimd::Vec xa = qsimd::load(&x.a[i]), xb = qsimd::load(&x.b[i]);
+            qsimd::Vec xc = qsimd::load(&x.c[i]), xd = qsimd::load(&x.d[i]);
+            qsimd::Vec ya = qsimd::load(&y.a[i]), yb = qsimd::load(&y.b[i]);
+            qsimd::Vec yc = qsimd::load(&y.c[i]), yd = qsimd::load(&y.d[i]);
+
+            qsimd::Vec ra = qsimd::sub(qsimd::sub(qsimd::sub(qsimd::mul(xa, ya), qsimd::mul(xb, yb)),
+                                                  qsimd::mul(xc, yc)), qsimd::mul(xd, yd));
+            qsimd::Vec rb = qsimd::sub(qsimd::add(qsimd::add(qsimd::mul(xa, yb), qsimd::mul(xb, ya)),
+                                                  qsimd::mul(xc, yd)), qsimd::mul(xd, yc));
+            qsimd::Vec rc = qsimd::add(qsimd::add(qsimd::sub(qsimd::mul(xa, yc), qsimd::mul(xb, yd)),
+                                                  qsimd::mul(xc, ya)), qsimd::mul(xd, yb));
+            qsimd::Vec rd = qsimd::add(qsimd::sub(qsimd::add(qsimd::mul(xa, yd), qsimd::mul(xb, yc)),
+                                                  qsimd::mul(xc, yb)), qsimd::mul(xd, ya));
+
+            qsimd::store(&out.a[i], ra);
+            qsimd::store(&out.b[i], rb);
+            qsimd::store(&out.c[i], rc);
+            qsimd::store(&out.d[i], rd);
+        }
+    }
+
+    // Сопряжение всех кватернионов пакета
+    void conjugate(QuaternionBatch &out) const {
+        if (out.count != count) out.resize(count);
+        std::size_t n = padded(count);
+        for (std::size_t i = 0; i < n; i += qsimd::lanes) {
+            qsimd::store(&out.a[i], qsimd::load(&a[i]));
+            qsimd::store(&out.b[i], qsimd::neg(qsimd::load(&b[i])));
+            qsimd::store(&out.c[i], qsimd::neg(qsimd::load(&c[i])));
+            qsimd::store(&out.d[i], qsimd::neg(qsimd::load(&d[i])));
+        }
+    }
+
+    // Нормализация всех кватернионов пакета
+    void normalize(QuaternionBatch &out) const {
+        if (out.count != count) out.resize(count);
+        std::size_t n = padded(count);
+        for (std::size_t i = 0; i < n; i += qsimd::lanes) {
+            qsimd::Vec va = qsimd::load(&a[i]), vb = qsimd::load(&b[i]);
+            qsimd::Vec vc = qsimd::load(&c[i]), vd = qsimd::load(&d[i]);
+            qsimd::Vec nrm = qsimd::sqrt(qsimd::add(qsimd::add(qsimd::add(qsimd::mul(va, va), qsimd::mul(vb, vb)),
+                                                               qsimd::mul(vc, vc)), qsimd::mul(vd, vd)));
+            qsimd::store(&out.a[i], qsimd::div(va, nrm));
+            qsimd::store(&out.b[i], qsimd::div(vb, nrm));
+            qsimd::store(&out.c[i], qsimd::div(vc, nrm));
+            qsimd::store(&out.d[i], qsimd::div(vd, nrm));
+        }
+    }
+
+    // Инверсия всех кватернионов пакета
+    void inverse(QuaternionBatch &out) const {
+        if (out.count != count) out.resize(count);
+        std::size_t n = padded(count);
+        qsimd::Vec one = qsimd::set1(1.0);
+        for (std::size_t i = 0; i < n; i += qsimd::lanes) {
+            qsimd::Vec va = qsimd::load(&a[i]), vb = qsimd::load(&b[i]);
+            qsimd::Vec vc = qsimd::load(&c[i]), vd = qsimd::load(&d[i]);
+            qsimd::Vec nrm = qsimd::sqrt(qsimd::add(qsimd::add(qsimd::add(qsimd::mul(va, va), qsimd::mul(vb, vb)),
+                                                               qsimd::mul(vc, vc)), qsimd::mul(vd, vd)));
+            qsimd::Vec r = qsimd::div(one, qsimd::mul(nrm, nrm));
+            qsimd::store(&out.a[i], qsimd::mul(va, r));
+            qsimd::store(&out.b[i], qsimd::mul(qsimd::neg(vb), r));
+            qsimd::store(&out.c[i], qsimd::mul(qsimd::neg(vc), r));
+            qsimd::store(&out.d[i], qsimd::mul(qsimd::neg(vd), r));
+        }
+    }
+
+    // Скалярные произведения: out[i] = this[i] . q[i], out должен вмещать size() значений
+    void dot(const QuaternionBatch &q, double *out) const {
+        checkSize(q);
+        std::size_t full = count / qsimd::lanes * qsimd::lanes;
+        std::size_t i = 0;
+        for (; i < full; i += qsimd::lanes) {
+            qsimd::Vec r = qsimd::add(qsimd::add(qsimd::add(
+                qsimd::mul(qsimd::load(&a[i]), qsimd::load(&q.a[i])),
+                qsimd::mul(qsimd::load(&b[i]), qsimd::load(&q.b[i]))),
+                qsimd::mul(qsimd::load(&c[i]), qsimd::load(&q.c[i]))),
+                qsimd::mul(qsimd::load(&d[i]), qsimd::load(&q.d[i])));
+            alignas(32) double tmp[qsimd::lanes];
+            qsimd::store(tmp, r);
+            for (std::size_t j = 0; j < qsimd::lanes; ++j) out[i + j] = tmp[j];
+        }
+        for (; i < count; ++i) {
+            out[i] = a[i] * q.a[i] + b[i] * q.b[i] + c[i] * q.c[i] + d[i] * q.d[i];
+        }
+    }
+};
+
+// ===== Пакетный поворот точек =====
+
+// Делит [0, n) на threads кусков (границы кратны 8, чтобы SIMD-блоки не разрывались)
+// и вызывает body(begin, end) для каждого; при threads <= 1 работает в текущем потоке
+template <typename Body>
+void parallelRanges(std::size_t n, unsigned threads, Body body) {
+    if (threads <= 1 || n < 8 * std::size_t(threads)) {
+        body(std::size_t(0), n);
+        return;
+    }
+    std::size_t chunk = (n / threads + 7) / 8 * 8;
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (std::size_t begin = 0; begin < n; begin += chunk) {
+        std::size_t end = std::min(n, begin + chunk);
+        pool.emplace_back([=] { body(begin, end); });
+    }
+    for (auto &t : pool) t.join();
+}
+
+// Поворот точек (SoA: отдельные массивы x, y, z) одним единичным кватернионом.
+// Кватернион один раз превращается в матрицу, дальше 9 умножений и 6 сложений на точку.
+// Выходные массивы могут совпадать с входными.
+inline void rotatePoints(const Quaterniond &q, const double *x, const double *y, const double *z,
+                         double *outX, double *outY, double *outZ, std::size_t n, unsigned threads = 1) {
+    Matrix3d r = q.toRotationMatrix();
+    parallelRanges(n, threads, [&](std::size_t begin, std::size_t end) {
+        qsimd::Vec m[3][3];
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j) m[i][j] = qsimd::set1(r.m[i][j]);
+
+        std::size_t i = begin;
+        for (; i + qsimd::lanes <= end; i += qsimd::lanes) {
+            qsimd::Vec vx = qsimd::loadu(x + i), vy = qsimd::loadu(y + i), vz = qsimd::loadu(z + i);
+            qsimd::storeu(outX + i, qsimd::add(qsimd::add(qsimd::mul(m[0][0], vx), qsimd::mul(m[0][1], vy)), qsimd::mul(m[0][2], vz)));
+            qsimd::storeu(outY + i, qsimd::add(qsimd::add(qsimd::mul(m[1][0], vx), qsimd::mul(m[1][1], vy)), qsimd::mul(m[1][2], vz)));
+            qsimd::storeu(outZ + i, qsimd::add(qsimd::add(qsimd::mul(m[2][0], vx), qsimd::mul(m[2][1], vy)), qsimd::mul(m[2][2], vz)));
+        }
+        for (; i < end; ++i) {
+            double px = x[i], py = y[i], pz = z[i];
+            outX[i] = r.m[0][0] * px + r.m[0][1] * py + r.m[0][2] * pz;
+            outY[i] = r.m[1][0] * px + r.m[1][1] * py + r.m[1][2] * pz;
+            outZ[i] = r.m[2][0] * px + r.m[2][1] * py + r.m[2][2] * pz;
+        }
+    });
+}
+
+// Поворот точек (AoS: массив Vec3) одним единичным кватернионом любой точности
+template <typename T>
+void rotatePoints(const Quaternion<T> &q, const Vec3<T> *in, Vec3<T> *out, std::size_t n, unsigned threads = 1) {
+    Matrix3<T> r = q.toRotationMatrix();
+    parallelRanges(n, threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            Vec3<T> p = in[i];
+            out[i] = Vec3<T>{r.m[0][0] * p.x + r.m[0][1] * p.y + r.m[0][2] * p.z,
+                             r.m[1][0] * p.x + r.m[1][1] * p.y + r.m[1][2] * p.z,
+                             r.m[2][0] * p.x + r.m[2][1] * p.y + r.m[2][2] * p.z};
+        }
+    });
+}
+
+// Поворот точек (SoA) своим единичным кватернионом для каждой точки: точка i поворачивается qs[i].
+// Быстрее поштучного Quaternion::rotate (SIMD по точкам), но медленнее поворота одним
+// кватернионом: читает еще 32 байта на точку и не может свести поворот к матрице.
+inline void rotatePoints(const QuaternionBatch &qs, const double *x, const double *y, const double *z,
+                         double *outX, double *outY, double *outZ, unsigned threads = 1) {
+    std::size_t n = qs.size();
+    const double *qa = qs.dataA(), *qb = qs.dataB(), *qc = qs.dataC(), *qd = qs.dataD();
+    parallelRanges(n, threads, [&](std::size_t begin, std::size_t end) {
+        qsimd::Vec two = qsimd::set1(2.0);
+        std::size_t i = begin;
+        for (; i + qsimd::lanes <= end; i += qsimd::lanes) {
+            qsimd::Vec a = qsimd::load(qa + i), b = qsimd::load(qb + i);
+            qsimd::Vec c = qsimd::load(qc + i), d = qsimd::load(qd + i);
+            qsimd::Vec vx = qsimd::loadu(x + i), vy = qsimd::loadu(y + i), vz = qsimd::loadu(z + i);
+
+            // t = 2 (u x v)
+            qsimd::Vec tx = qsimd::mul(two, qsimd::sub(qsimd::mul(c, vz), qsimd::mul(d, vy)));
+            qsimd::Vec ty = qsimd::mul(two, qsimd::sub(qsimd::mul(d, vx), qsimd::mul(b, vz)));
+            qsimd::Vec tz = qsimd::mul(two, qsimd::sub(qsimd::mul(b, vy), qsimd::mul(c, vx)));
+
+            // v' = v + a t + u x t
+            qsimd::storeu(outX + i, qsimd::add(qsimd::add(vx, qsimd::mul(a, tx)), qsimd::sub(qsimd::mul(c, tz), qsimd::mul(d, ty))));
+            qsimd::storeu(outY + i, qsimd::add(qsimd::add(vy, qsimd::mul(a, ty)), qsimd::sub(qsimd::mul(d, tx), qsimd::mul(b, tz))));
+            qsimd::storeu(outZ + i, qsimd::add(qsimd::add(vz, qsimd::mul(a, tz)), qsimd::sub(qsimd::mul(b, ty), qsimd::mul(c, tx))));
+        }
+        for (; i < end; ++i) {
+            Vec3d p = Quaterniond(qa[i], qb[i], qc[i], qd[i]).rotate(Vec3d{x[i], y[i], z[i]});
+            outX[i] = p.x;
+            outY[i] = p.y;
+            outZ[i] = p.z;
+        }
+    });
+}
+
+// ===== Интерполяция кватернионов =====
+//
+// Все функции ожидают единичные кватернионы. nlerp и slerp идут по кратчайшей
+// дуге (при отрицательном скалярном произведении второй кватернион меняет знак),
+// slerpArc и внутренние дуги squad - нет.
+//
+// Режим FAST:
+//  - slerp: nlerp с полиномиальной коррекцией параметра t (без acos и sin),
+//    угловая ошибка относительно точного slerp не более 8e-4 рад; на сегменте
+//    с готовым углом в 1.6-1.8 раза быстрее точного (в 2.3-2.6 с -march=native);
+//  - squad: те же приближенные slerp внутри, ошибка не более 1e-3 рад;
+//  - у nlerp режима нет: полиномиальная оценка 1/sqrt с итерациями Ньютона
+//    оказалась медленнее аппаратного sqrt.
+// Границы и время проверяются в dz01_bench.cpp (раздел slerp).
+
+enum class InterpolationMode {
+    EXACT, // точные формулы
+    FAST   // приближенные формулы с оценкой ошибки (см. выше)
+};
+
+// Параметр, не участвующий в выводе шаблона (slerp(qf, qf, 0.5) для float)
+template <typename T>
+struct NonDeduced {
+    typedef T type;
+};
+
+// Коррекция параметра t, приближающая nlerp к slerp (d = |q0 . q1|)
+template <typename T>
+T slerpCorrectedT(T t, T d) {
+    T A = T(1.0904) + d * (T(-3.2452) + d * (T(3.55645) - d * T(1.43519)));
+    T B = T(0.848013) + d * (T(-1.06021) + d * T(0.215638));
+    T k = A * (t - T(0.5)) * (t - T(0.5)) + B;
+    return t + t * (t - T(0.5)) * (t - 1) * k;
+}
+
+// Сегмент между двумя ключевыми кадрами с заранее вычисленными углом и константами.
+// Вычисление точки на сегменте не требует скалярного произведения и acos; деление
+// остается только в нормировке nlerp (1 / sqrt).
+template <typename T>
+class SlerpSegment {
+private:
+    Quaternion<T> q0, q1; // Концы сегмента (q1 приведен к одной полусфере с q0)
+    T cosTheta;           // Скалярное произведение концов
+    T theta;              // Угол между концами
+    T invSinTheta;        // 1 / sin(theta)
+    bool nearlyLinear;    // Угол слишком мал для формулы slerp
+
+public:
+    SlerpSegment() : cosTheta(1), theta(0), invSinTheta(0), nearlyLinear(true) {}
+    // shortestPath = false сохраняет знак to (нужно для внутренних дуг squad)
+    SlerpSegment(const Quaternion<T> &from, const Quaternion<T> &to, bool shortestPath = true) : q0(from), q1(to) {
+        cosTheta = from.dotProduct(to);
+        if (shortestPath && cosTheta < 0) {
+            q1 = to * T(-1);
+            cosTheta = -cosTheta;
+        }
+        cosTheta = std::max(T(-1), std::min(cosTheta, T(1)));
+        theta = std::acos(cosTheta);
+        nearlyLinear = cosTheta > T(0.9995);
+        invSinTheta = nearlyLinear ? 0 : 1 / std::sin(theta);
+    }
+
+    const Quaternion<T> &from() const { return q0; }
+    const Quaternion<T> &to() const { return q1; }
+    T angle() const { return theta; }
+
+    // Нормализованная линейная интерполяция
+    Quaternion<T> nlerp(T t) const {
+        // |(1-t)q0 + t q1|^2 = 1 - 2t(1-t)(1 - cos(theta)) для единичных q0 и q1
+        T n2 = 1 - 2 * t * (1 - t) * (1 - cosTheta);
+        return (q0 * (1 - t) + q1 * t) * (1 / std::sqrt(n2));
+    }
+
+    // Сферическая линейная интерполяция
+    Quaternion<T> slerp(T t, InterpolationMode mode = InterpolationMode::EXACT) const {
+        if (mode == InterpolationMode::FAST && cosTheta >= 0) {
+            return nlerp(slerpCorrectedT(t, cosTheta));
+        }
+        if (nearlyLinear) {
+            return nlerp(t);
+        }
+        T w0 = std::sin((1 - t) * theta) * invSinTheta;
+        T w1 = std::sin(t * theta) * invSinTheta;
+        return q0 * w0 + q1 * w1;
+    }
+};
+
+// Нормализованная линейная интерполяция
+template <typename T>
+Quaternion<T> nlerp(const Quaternion<T> &q0, const Quaternion<T> &q1, typename NonDeduced<T>::type t) {
+    return SlerpSegment<T>(q0, q1).nlerp(t);
+}
+
+// Slerp по дуге от p к r без выбора кратчайшего пути
+template <typename T>
+Quaternion<T> slerpArc(const Quaternion<T> &p, const Quaternion<T> &r, typename NonDeduced<T>::type t,
+                       InterpolationMode mode = InterpolationMode::EXACT) {
+    T d = p.dotProduct(r);
+    if (mode == InterpolationMode::FAST && d >= 0) {
+        // Без acos и sin: nlerp со скорректированным параметром
+        d = std::min(d, T(1));
+        T u = slerpCorrectedT(t, d);
+        T n2 = 1 - 2 * u * (1 - u) * (1 - d);
+        return (p * (1 - u) + r * u) * (1 / std::sqrt(n2));
+    }
+    return SlerpSegment<T>(p, r, false).slerp(t);
+}
+
+// Сферическая линейная интерполяция
+template <typename T>
+Quaternion<T> slerp(const Quaternion<T> &q0, const Quaternion<T> &q1, typename NonDeduced<T>::type t,
+                    InterpolationMode mode = InterpolationMode::EXACT) {
+    return slerpArc(q0, q0.dotProduct(q1) < 0 ? q1 * T(-1) : q1, t, mode);
+}
+
+// Промежуточная точка squad для ключа q с соседями prev и next
+template <typename T>
+Quaternion<T> squadControlPoint(const Quaternion<T> &prev, const Quaternion<T> &q, const Quaternion<T> &next) {
+    Quaternion<T> qi = q.conjugate();
+    Quaternion<T> l = ((qi * next).log() + (qi * prev).log()) * T(-0.25);
+    return q * l.exp();
+}
+
+// Сферическая кубическая интерполяция между q0 и q1 с промежуточными точками s0 и s1.
+// Дуги s0 -> s1 и внешняя дуга не укорачиваются, иначе кривая рвется там,
+// где скалярное произведение промежуточных результатов меняет знак.
+template <typename T>
+Quaternion<T> squad(const Quaternion<T> &q0, const Quaternion<T> &q1, const Quaternion<T> &s0,
+                    const Quaternion<T> &s1, typename NonDeduced<T>::type t,
+                    InterpolationMode mode = InterpolationMode::EXACT) {
+    return slerpArc(slerp(q0, q1, t, mode), slerpArc(s0, s1, t, mode), 2 * t * (1 - t), mode);
+}
+
+// Дорожка ключевых кадров: сегменты и промежуточные точки squad вычисляются один раз
+template <typename T>
+class QuaternionTrack {
+private:
+    std::vector<T> times;                  // Время ключей (строго по возрастанию)
+    std::vector<Quaternion<T> > keys;      // Ключи, приведенные к одной полусфере с предыдущим
+    std::vector<SlerpSegment<T> > segments; // keys[i] -> keys[i + 1]
+    std::vector<SlerpSegment<T> > controls; // s[i] -> s[i + 1] для squad
+
+    // Номер сегмента и локальный параметр для момента time
+    std::size_t locate(T time, T &t) const {
+        if (time <= times.front()) {
+            t = 0;
+            return 0;
+        }
+        if (time >= times.back()) {
+            t = 1;
+            return segments.size() - 1;
+        }
+        std::size_t i = std::upper_bound(times.begin(), times.end(), time) - times.begin() - 1;
+        t = (time - times[i]) / (times[i + 1] - times[i]);
+        return i;
+    }
+
+public:
+    QuaternionTrack(const std::vector<T> &keyTimes, const std::vector<Quaternion<T> > &keyFrames) {
+        if (keyTimes.size() != keyFrames.size() || keyFrames.size() < 2) {
+            throw std::invalid_argument("Нужно не меньше двух ключей и столько же отметок времени");
+        }
+        // locate ищет сегмент бинарным поиском и делит на длину сегмента
+        for (std::size_t i = 0; i < keyTimes.size(); ++i) {
+            if (!std::isfinite(keyTimes[i]) || (i > 0 && !(keyTimes[i - 1] < keyTimes[i]))) {
+                throw std::invalid_argument("Время ключей должно быть конечным и строго возрастать");
+            }
+        }
+        times = keyTimes;
+        keys.reserve(keyFrames.size());
+        for (std::size_t i = 0; i < keyFrames.size(); ++i) {
+            Quaternion<T> q = keyFrames[i].normalize();
+            if (i > 0 && keys.back().dotProduct(q) < 0) {
+                q = q * T(-1);
+            }
+            keys.push_back(q);
+        }
+
+        std::vector<Quaternion<T> > s(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            const Quaternion<T> &prev = keys[i == 0 ? 0 : i - 1];
+            const Quaternion<T> &next = keys[i + 1 == keys.size() ? i : i + 1];
+            s[i] = squadControlPoint(prev, keys[i], next);
+        }
+
+        segments.reserve(keys.size() - 1);
+        controls.reserve(keys.size() - 1);
+        for (std::size_t i = 0; i + 1 < keys.size(); ++i) {
+            segments.push_back(SlerpSegment<T>(keys[i], keys[i + 1]));
+            controls.push_back(SlerpSegment<T>(s[i], s[i + 1], false));
+        }
+    }
+
+    std::size_t size() const { return keys.size(); }
+
+    Quaternion<T> nlerp(T time) const {
+        T t;
+        std::size_t i = locate(time, t);
+        return segments[i].nlerp(t);
+    }
+
+    Quaternion<T> slerp(T time, InterpolationMode mode = InterpolationMode::EXACT) const {
+        T t;
+        std::size_t i = locate(time, t);
+        return segments[i].slerp(t, mode);
+    }
+
+    Quaternion<T> squad(T time, InterpolationMode mode = InterpolationMode::EXACT) const {
+        T t;
+        std::size_t i = locate(time, t);
+        return slerpArc(segments[i].slerp(t, mode), controls[i].slerp(t, mode), 2 * t * (1 - t), mode);
+    }
+
+    // Пакетная выборка: out[j] = f(sampleTimes[j])
+    void sampleNlerp(const T *sampleTimes, Quaternion<T> *out, std::size_t n) const {
+        for (std::size_t j = 0; j < n; ++j) out[j] = nlerp(sampleTimes[j]);
+    }
+    void sampleSlerp(const T *sampleTimes, Quaternion<T> *out, std::size_t n,
+                     InterpolationMode mode = InterpolationMode::EXACT) const {
+        for (std::size_t j = 0; j < n; ++j) out[j] = slerp(sampleTimes[j], mode);
+    }
+    void sampleSquad(const T *sampleTimes, Quaternion<T> *out, std::size_t n,
+                     InterpolationMode mode = InterpolationMode::EXACT) const {
+        for (std::size_t j = 0; j < n; ++j) out[j] = squad(sampleTimes[j], mode);
     }
 };
 
@@ -0,0 +1,481 @@
+// Микробенчмарки для dz01 (кватернионы и эллипсы): запуск без аргументов
+// выполняет все разделы, имя раздела в аргументе командной строки - только его.
+
+#include "dz01_QUATERNION.cpp"
+#include "dz01_ELLIPSIS.cpp"
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdio>
+#include <clocale>
+
+// Среднее время одного повтора функции f, нс
+template <typename F>
+double measureNs(F f, int repeats) {
+    f(); // прогрев
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / repeats;
+}
+
+// Лучшее из rounds измерений measureNs: разброс между прогонами на общей машине
+// больше разницы между ядрами, которые сравниваются
+template <typename F>
+double bestNs(F f, int repeats, int rounds = 5) {
+    double best = measureNs(f, repeats);
+    for (int r = 1; r < rounds; ++r) best = std::min(best, measureNs(f, repeats));
+    return best;
+}
+
+// Случайный единичный кватернион
+Quaterniond randomUnitQuaternion(std::mt19937 &gen) {
+    std::normal_distribution<double> dist(0.0, 1.0);
+    return Quaterniond(dist(gen), dist(gen), dist(gen), dist(gen)).normalize();
+}
+
+// Угол между поворотами, которые задают два кватерниона, рад
+double rotationAngle(const Quaterniond &p, const Quaterniond &q) {
+    return 2 * acos(std::min(1.0, fabs(p.normalize().dotProduct(q.normalize()))));
+}
+
+// Slerp, собранный вручную из функций-членов Quaterniond (как в исходном коде анимации)
+Quaterniond naiveSlerp(const Quaterniond &q0, const Quaterniond &q1, double t) {
+    Quaterniond e = q1;
+    double d = q0.dotProduct(q1);
+    if (d < 0) {
+        e = q1 * -1.0;
+        d = -d;
+    }
+    double theta = acos(std::min(1.0, d / (q0.norm() * e.norm())));
+    double s = sqrt(1 - pow(cos(theta), 2));
+    if (s < 1e-9) {
+        return (q0 * (1 - t) + e * t).normalize();
+    }
+    return (q0 * (sin((1 - t) * theta) / s) + e * (sin(t * theta) / s)).normalize();
+}
+
+void benchSlerp() {
+    std::printf("== slerp / nlerp / squad ==\n");
+    std::mt19937 gen(42);
+
+    // Дорожка из случайных ключей и монотонные отсчеты времени, как при проигрывании анимации
+    const std::size_t keyCount = 256, sampleCount = 1 << 18;
+    std::vector<double> keyTimes(keyCount);
+    std::vector<Quaterniond> keyFrames(keyCount);
+    for (std::size_t i = 0; i < keyCount; ++i) {
+        keyTimes[i] = double(i);
+        keyFrames[i] = randomUnitQuaternion(gen);
+    }
+    QuaternionTrack<double> track(keyTimes, keyFrames);
+
+    std::vector<double> sampleTimes(sampleCount);
+    for (std::size_t j = 0; j < sampleCount; ++j) {
+        sampleTimes[j] = double(keyCount - 1) * j / (sampleCount - 1);
+    }
+    std::vector<Quaterniond> out(sampleCount);
+
+    // Точность приближенных режимов
+    double slerpErr = 0, squadErr = 0;
+    for (std::size_t j = 0; j < sampleCount; ++j) {
+        double time = sampleTimes[j];
+        slerpErr = std::max(slerpErr, rotationAngle(track.slerp(time), track.slerp(time, InterpolationMode::FAST)));
+        squadErr = std::max(squadErr, rotationAngle(track.squad(time), track.squad(time, InterpolationMode::FAST)));
+    }
+    std::printf("max ошибка slerp FAST, рад:  %.3g\n", slerpErr);
+    std::printf("max ошибка squad FAST, рад:  %.3g\n", squadErr);
+
+    double naive = bestNs([&] {
+        for (std::size_t j = 0; j < sampleCount; ++j) {
+            std::size_t i = std::min(std::size_t(sampleTimes[j]), keyCount - 2);
+            out[j] = naiveSlerp(keyFrames[i], keyFrames[i + 1], sampleTimes[j] - double(i));
+        }
+    }, 5) / sampleCount;
+    std::printf("%-28s %8.2f нс/отсчет\n", "slerp наивный", naive);
+
+    double nlerp = bestNs([&] { track.sampleNlerp(sampleTimes.data(), out.data(), sampleCount); }, 5) / sampleCount;
+    std::printf("%-28s %8.2f нс/отсчет (x%.1f)\n", "nlerp", nlerp, naive / nlerp);
+
+    struct Case {
+        const char *name;
+        void (QuaternionTrack<double>::*fn)(const double *, Quaterniond *, std::size_t, InterpolationMode) const;
+        InterpolationMode mode;
+    } cases[] = {
+        {"slerp EXACT", &QuaternionTrack<double>::sampleSlerp, InterpolationMode::EXACT},
+        {"slerp FAST", &QuaternionTrack<double>::sampleSlerp, InterpolationMode::FAST},
+        {"squad EXACT", &QuaternionTrack<double>::sampleSquad, InterpolationMode::EXACT},
+        {"squad FAST", &QuaternionTrack<double>::sampleSquad, InterpolationMode::FAST},
+    };
+    for (const Case &c : cases) {
+        double ns = bestNs([&] {
+            (track.*c.fn)(sampleTimes.data(), out.data(), sampleCount, c.mode);
+        }, 5) / sampleCount;
+        std::printf("%-28s %8.2f нс/отсчет (x%.1f)\n", c.name, ns, naive / ns);
+    }
+
+    // Сам slerp на сегментах с готовым углом, без поиска сегмента по времени,
+    // который в выборке с дорожки занимает заметную долю
+    std::vector<SlerpSegment<double> > segments;
+    for (std::size_t i = 0; i + 1 < keyCount; ++i) segments.push_back(SlerpSegment<double>(keyFrames[i], keyFrames[i + 1]));
+    const std::size_t perSegment = sampleCount / segments.size();
+    double segmentNs[2];
+    for (InterpolationMode mode : {InterpolationMode::EXACT, InterpolationMode::FAST}) {
+        segmentNs[int(mode)] = bestNs([&] {
+            std::size_t j = 0;
+            for (const SlerpSegment<double> &s : segments)
+                for (std::size_t k = 0; k < perSegment; ++k) out[j++] = s.slerp(double(k) / perSegment, mode);
+        }, 5) / double(segments.size() * perSegment);
+    }
+    std::printf("SlerpSegment::slerp EXACT    %8.2f нс/отсчет\n", segmentNs[0]);
+    std::printf("SlerpSegment::slerp FAST     %8.2f нс/отсчет (x%.1f к EXACT)\n", segmentNs[1], segmentNs[0] / segmentNs[1]);
+    std::printf("\n");
+}
+
+void benchRotate() {
+    std::printf("== поворот точек ==\n");
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> coord(-100.0, 100.0);
+
+    const std::size_t n = 1 << 20;
+    std::vector<double> x(n), y(n), z(n), ox(n), oy(n), oz(n);
+    std::vector<Vec3d> points(n), out(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = coord(gen);
+        y[i] = coord(gen);
+        z[i] = coord(gen);
+        points[i] = Vec3d{x[i], y[i], z[i]};
+    }
+    Quaterniond q = randomUnitQuaternion(gen);
+    QuaternionBatch qs(n);
+    for (std::size_t i = 0; i < n; ++i) qs.set(i, randomUnitQuaternion(gen));
+
+    // Проверка: rotate и матрица совпадают с q * p * q.inverse(), матрица обратима
+    double rotateErr = 0, matrixErr = 0;
+    Quaterniond back = Quaterniond::fromRotationMatrix(q.toRotationMatrix());
+    for (std::size_t i = 0; i < 1000; ++i) {
+        Quaterniond p(0, x[i], y[i], z[i]);
+        Quaterniond ref = q * p * q.inverse();
+        Vec3d v = q.rotate(points[i]);
+        Vec3d w = back.rotate(points[i]);
+        rotateErr = std::max({rotateErr, fabs(v.x - ref.getB()), fabs(v.y - ref.getC()), fabs(v.z - ref.getD())});
+        matrixErr = std::max({matrixErr, fabs(w.x - v.x), fabs(w.y - v.y), fabs(w.z - v.z)});
+    }
+    std::printf("max |rotate - q*p*q^-1|:    %.3g\n", rotateErr);
+    std::printf("max ошибка матрица->q:      %.3g\n", matrixErr);
+
+    double naive = measureNs([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            Quaterniond r = q * Quaterniond(0, x[i], y[i], z[i]) * q.inverse();
+            ox[i] = r.getB();
+            oy[i] = r.getC();
+            oz[i] = r.getD();
+        }
+    }, 5) / n;
+    std::printf("%-28s %8.2f нс/точку\n", "q * p * q.inverse()", naive);
+
+    double single = bestNs([&] {
+        for (std::size_t i = 0; i < n; ++i) out[i] = q.rotate(points[i]);
+    }, 5) / n;
+    std::printf("%-28s %8.2f нс/точку (x%.1f)\n", "Quaternion::rotate", single, naive / single);
+
+    double aos = bestNs([&] { rotatePoints(q, points.data(), out.data(), n); }, 5) / n;
+    std::printf("%-28s %8.2f нс/точку (x%.1f)\n", "rotatePoints AoS", aos, naive / aos);
+
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    double soa = bestNs([&] {
+        rotatePoints(q, x.data(), y.data(), z.data(), ox.data(), oy.data(), oz.data(), n);
+    }, 5) / n;
+    std::printf("%-28s %8.2f нс/точку (x%.1f)\n", "rotatePoints SoA", soa, naive / soa);
+
+    double soaMt = bestNs([&] {
+        rotatePoints(q, x.data(), y.data(), z.data(), ox.data(), oy.data(), oz.data(), n, threads);
+    }, 5) / n;
+    std::printf("rotatePoints SoA, %2u потоков %8.2f нс/точку (x%.1f)\n", threads, soaMt, naive / soaMt);
+
+    // Свой кватернион на точку сравнивается с тем же поворотом поштучно: с одним
+    // кватернионом пакет не сравним - он читает 80 байт на точку вместо 48
+    // и делает вдвое больше операций
+    auto rotateEach = [&](const QuaternionBatch &batch) {
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            Vec3d p = batch.get(i).rotate(Vec3d{x[i], y[i], z[i]});
+            ox[i] = p.x;
+            oy[i] = p.y;
+            oz[i] = p.z;
+        }
+    };
+    double each = bestNs([&] { rotateEach(qs); }, 5) / n;
+    std::printf("свой q: Quaternion::rotate   %8.2f нс/точку\n", each);
+    double many = bestNs([&] {
+        rotatePoints(qs, x.data(), y.data(), z.data(), ox.data(), oy.data(), oz.data());
+    }, 5) / n;
+    std::printf("свой q: rotatePoints         %8.2f нс/точку (x%.1f)\n", many, each / many);
+    double manyMt = bestNs([&] {
+        rotatePoints(qs, x.data(), y.data(), z.data(), ox.data(), oy.data(), oz.data(), threads);
+    }, 5) / n;
+    std::printf("свой q, %2u потоков           %8.2f нс/точку (x%.1f)\n", threads, manyMt, each / manyMt);
+
+    // Те же ядра на блоке, который помещается в кэш: на 2^20 точках все они упираются
+    // в пропускную способность памяти, здесь видна разница в арифметике
+    const std::size_t block = 2048;
+    const int blockRepeats = int(n / block);
+    QuaternionBatch qsBlock(block);
+    for (std::size_t i = 0; i < block; ++i) qsBlock.set(i, qs.get(i));
+    double aosBlock = bestNs([&] { rotatePoints(q, points.data(), out.data(), block); }, blockRepeats) / block;
+    double soaBlock = bestNs([&] {
+        rotatePoints(q, x.data(), y.data(), z.data(), ox.data(), oy.data(), oz.data(), block);
+    }, blockRepeats) / block;
+    double eachBlock = bestNs([&] { rotateEach(qsBlock); }, blockRepeats) / block;
+    double manyBlock = bestNs([&] {
+        rotatePoints(qsBlock, x.data(), y.data(), z.data(), ox.data(), oy.data(), oz.data());
+    }, blockRepeats) / block;
+    std::printf("блок %zu точек в кэше: AoS %.2f, SoA %.2f (x%.1f); свой q: поштучно %.2f, пакет %.2f (x%.1f) нс/точку\n",
+                block, aosBlock, soaBlock, aosBlock / soaBlock, eachBlock, manyBlock, eachBlock / manyBlock);
+    std::printf("\n");
+}
+
+void benchEllipseClassify() {
+    std::printf("== точки внутри эллипса ==\n");
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<double> coord(-10.0, 10.0);
+
+    const std::size_t n = 1 << 22;
+    std::vector<double> xs(n), ys(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        xs[i] = coord(gen);
+        ys[i] = coord(gen);
+    }
+    Ellipsis e(1.5, -2.0, 6.0, 3.5);
+    std::vector<std::uint64_t> mask(EllipsisBatch::maskWords(n));
+    std::vector<char> inside(n);
+
+    double scalar = measureNs([&] {
+        for (std::size_t i = 0; i < n; ++i) inside[i] = e.isPointInside(xs[i], ys[i]);
+    }, 5) / n;
+    std::printf("%-28s %8.3f нс/точку\n", "isPointInside", scalar);
+
+    double batch = measureNs([&] { EllipsisBatch::classify(e, xs.data(), ys.data(), n, mask.data()); }, 5) / n;
+    std::printf("%-28s %8.3f нс/точку (x%.1f)\n", "EllipsisBatch::classify", batch, scalar / batch);
+
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    double batchMt = measureNs([&] {
+        EllipsisBatch::classify(e, xs.data(), ys.data(), n, mask.data(), threads);
+    }, 5) / n;
+    std::printf("classify, %2u потоков        %8.3f нс/точку (x%.1f)\n", threads, batchMt, scalar / batchMt);
+
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        mismatches += ((mask[i / 64] >> (i % 64)) & 1) != std::uint64_t(inside[i]);
+    }
+    std::printf("расхождений с isPointInside: %zu\n", mismatches);
+
+    // Много эллипсов: маски по каждому
+    const std::size_t m = 64, points = 1 << 18;
+    std::vector<Ellipsis> es;
+    std::uniform_real_distribution<double> axis(0.5, 4.0);
+    for (std::size_t j = 0; j < m; ++j) es.push_back(Ellipsis(coord(gen), coord(gen), axis(gen), axis(gen)));
+    std::vector<std::uint64_t> masks(m * EllipsisBatch::maskWords(points));
+
+    double manyScalar = measureNs([&] {
+        for (std::size_t j = 0; j < m; ++j)
+            for (std::size_t i = 0; i < points; ++i) inside[i] = es[j].isPointInside(xs[i], ys[i]);
+    }, 3) / (m * points);
+    double many = measureNs([&] {
+        EllipsisBatch::classifyMany(es.data(), m, xs.data(), ys.data(), points, masks.data(), threads);
+    }, 3) / (m * points);
+    std::printf("%zu эллипсов, isPointInside  %8.3f нс/пару\n", m, manyScalar);
+    std::printf("%zu эллипсов, classifyMany   %8.3f нс/пару (x%.1f)\n", m, many, manyScalar / many);
+    std::printf("\n");
+}
+
+void benchEllipseIndex() {
+    std::printf("== EllipseIndex ==\n");
+    std::mt19937 gen(13);
+    std::uniform_real_distribution<double> coord(0.0, 1000.0);
+    std::uniform_real_distribution<double> axis(0.5, 5.0);
+
+    const std::size_t m = 20000, queries = 20000, k = 8;
+    std::vector<Ellipsis> ellipses;
+    // Каждый 2000-й - выброс в 1000 раз крупнее среднего: попадает в список крупных, а не в сетку
+    for (std::size_t j = 0; j < m; ++j) {
+        double scale = j % 2000 == 0 ? 1000.0 : 1.0;
+        ellipses.push_back(Ellipsis(coord(gen), coord(gen), scale * axis(gen), scale * axis(gen)));
+    }
+    std::vector<double> qx(queries), qy(queries);
+    for (std::size_t i = 0; i < queries; ++i) {
+        qx[i] = coord(gen);
+        qy[i] = coord(gen);
+    }
+
+    EllipseIndex index(ellipses);
+
+    // Перебор всех эллипсов для сравнения
+    auto bruteContaining = [&](double x, double y) {
+        std::vector<std::size_t> r;
+        for (std::size_t j = 0; j < m; ++j)
+            if (ellipses[j].isPointInside(x, y)) r.push_back(j);
+        return r;
+    };
+    auto bruteNearest = [&](double x, double y) {
+        std::vector<std::pair<double, std::size_t> > r;
+        for (std::size_t j = 0; j < m; ++j) r.push_back({EllipseIndex::distance(ellipses[j], x, y), j});
+        std::partial_sort(r.begin(), r.begin() + k, r.end());
+        r.resize(k);
+        return r;
+    };
+
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < 500; ++i) {
+        std::vector<std::size_t> a = index.containing(qx[i], qy[i]), b = bruteContaining(qx[i], qy[i]);
+        std::sort(a.begin(), a.end());
+        mismatches += a != b;
+        auto na = index.nearest(qx[i], qy[i], k), nb = bruteNearest(qx[i], qy[i]);
+        for (std::size_t j = 0; j < k; ++j) mismatches += na[j].first != nb[j].first;
+        std::vector<std::size_t> o = index.overlapping(qx[i], qy[i], qx[i] + 20, qy[i] + 10);
+        std::size_t bo = 0;
+        for (const auto &e : ellipses) {
+            double dx = std::max(qx[i] - e.getH(), std::max(0.0, e.getH() - qx[i] - 20));
+            double dy = std::max(qy[i] - e.getK(), std::max(0.0, e.getK() - qy[i] - 10));
+            bo += dx * dx / (e.getA() * e.getA()) + dy * dy / (e.getB() * e.getB()) <= 1;
+        }
+        mismatches += o.size() != bo;
+    }
+    std::printf("расхождений с перебором:     %zu\n", mismatches);
+
+    std::size_t sink = 0;
+    double brute = measureNs([&] {
+        for (std::size_t i = 0; i < 200; ++i) sink += bruteContaining(qx[i], qy[i]).size();
+    }, 3) / 200;
+    double grid = measureNs([&] {
+        for (std::size_t i = 0; i < queries; ++i) sink += index.containing(qx[i], qy[i]).size();
+    }, 3) / queries;
+    std::printf("containing: перебор %10.0f нс, индекс %8.0f нс (x%.0f)\n", brute, grid, brute / grid);
+
+    double bruteK = measureNs([&] {
+        for (std::size_t i = 0; i < 50; ++i) sink += bruteNearest(qx[i], qy[i]).size();
+    }, 3) / 50;
+    double gridK = measureNs([&] {
+        for (std::size_t i = 0; i < queries; ++i) sink += index.nearest(qx[i], qy[i], k).size();
+    }, 3) / queries;
+    std::printf("nearest k=%zu: перебор %9.0f нс, индекс %8.0f нс (x%.0f)\n", k, bruteK, gridK, bruteK / gridK);
+
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    double batch = measureNs([&] {
+        sink += index.nearestBatch(qx.data(), qy.data(), queries, k, threads).size();
+    }, 3) / queries;
+    std::printf("nearestBatch, %2u потоков: %8.0f нс/запрос\n", threads, batch);
+
+    double update = measureNs([&] {
+        for (std::size_t j = 0; j < 1000; ++j) {
+            std::size_t id = index.insert(ellipses[j]);
+            index.remove(id);
+        }
+    }, 3) / 1000;
+    std::printf("insert + remove:             %8.0f нс\n", update);
+
+    Ellipsis outlier(500.0, 500.0, 3000.0, 2000.0);
+    double updateLarge = measureNs([&] { index.remove(index.insert(outlier)); }, 1000);
+    double everything = measureNs([&] { sink += index.overlapping(-1e6, -1e6, 1e6, 1e6).size(); }, 3);
+    std::printf("insert + remove выброса:     %8.0f нс (крупных в индексе %zu)\n", updateLarge, index.largeCount());
+    std::printf("overlapping в +-1e6:         %8.0f мкс, найдено %zu из %zu\n", everything / 1000,
+                index.overlapping(-1e6, -1e6, 1e6, 1e6).size(), index.size());
+    std::printf("(контрольная сумма %zu)\n\n", sink);
+}
+
+void benchPerimeter() {
+    std::printf("== периметр эллипса ==\n");
+    struct Tier {
+        const char *name;
+        PerimeterMethod method;
+    } tiers[] = {
+        {"Рамануджан I", PerimeterMethod::RAMANUJAN_I},
+        {"Рамануджан II", PerimeterMethod::RAMANUJAN_II},
+        {"AGM", PerimeterMethod::AGM},
+    };
+
+    // Ошибка относительно AGM по сетке b/a (AGM сверен с известным значением при b/a = 0.5)
+    std::printf("AGM(1, 0.5) - 4.84422411027383810 = %.2g\n", Ellipsis::perimeterAGM(1, 0.5) - 4.84422411027383810);
+    for (const Tier &t : tiers) {
+        double errAll = 0, errModerate = 0;
+        for (int i = 0; i <= 100000; ++i) {
+            double ratio = i / 100000.0;
+            Ellipsis e(0, 0, 1, ratio);
+            double exact = Ellipsis::perimeterAGM(1, ratio);
+            double err = fabs(e.getPerimeter(t.method) / exact - 1);
+            errAll = std::max(errAll, err);
+            if (ratio >= 0.1) errModerate = std::max(errModerate, err);
+        }
+        std::printf("%-16s ошибка: b/a >= 0.1: %.2g, все b/a: %.2g\n", t.name, errModerate, errAll);
+    }
+
+    std::mt19937 gen(17);
+    std::uniform_real_distribution<double> axis(0.01, 10.0);
+    const std::size_t n = 1 << 20;
+    std::vector<Ellipsis> es;
+    es.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) es.push_back(Ellipsis(0, 0, axis(gen), axis(gen)));
+    std::vector<double> out(n);
+
+    for (const Tier &t : tiers) {
+        double single = measureNs([&] {
+            for (std::size_t i = 0; i < n; ++i) out[i] = es[i].getPerimeter(t.method);
+        }, 5) / n;
+        double batch = measureNs([&] { perimeters(es.data(), n, out.data(), t.method); }, 5) / n;
+        std::printf("%-16s %6.2f нс/эллипс, пакетом %6.2f нс/эллипс\n", t.name, single, batch);
+    }
+    std::printf("\n");
+}
+
+void benchCompiledEllipse() {
+    std::printf("== CompiledEllipse ==\n");
+    std::mt19937 gen(19);
+    std::uniform_real_distribution<double> coord(-4.0, 4.0);
+    const std::size_t n = 1 << 20;
+    std::vector<double> xs(n), ys(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        xs[i] = coord(gen);
+        ys[i] = coord(gen);
+    }
+    Ellipsis e(0.5, -0.25, 4.0, 2.5);
+    CompiledEllipse ce = e.compile();
+
+    // Те же запросы, что в типичном цикле: фокусы, эксцентриситет, вторая координата, принадлежность
+    double diff = 0;
+    for (std::size_t i = 0; i < 1000; ++i) {
+        diff = std::max(diff, fabs(e.computeSecondCoordinate(xs[i], true) - ce.computeSecondCoordinate(xs[i], true)));
+        diff = std::max(diff, fabs(e.computeSecondCoordinate(ys[i] / 2, false) - ce.computeSecondCoordinate(ys[i] / 2, false)));
+    }
+    diff = std::max({diff, fabs(e.getEccentricity() - ce.getEccentricity()), fabs(e.getFoci().second - ce.getFoci().second)});
+    std::printf("max расхождение с Ellipsis:  %.3g\n", diff);
+
+    double sink = 0;
+    double plain = measureNs([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            sink += e.getFoci().second + e.getEccentricity() + e.getLR();
+            if (e.isPointInside(xs[i], ys[i])) sink += e.computeSecondCoordinate(xs[i], true);
+        }
+    }, 5) / n;
+    double compiled = measureNs([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            sink += ce.getFoci().second + ce.getEccentricity() + ce.getLR();
+            if (ce.isPointInside(xs[i], ys[i])) sink += ce.computeSecondCoordinate(xs[i], true);
+        }
+    }, 5) / n;
+    std::printf("%-28s %8.2f нс/итерацию\n", "Ellipsis", plain);
+    std::printf("%-28s %8.2f нс/итерацию (x%.1f)\n", "CompiledEllipse", compiled, plain / compiled);
+    std::printf("(контрольная сумма %g)\n\n", sink);
+}
+
+int main(int argc, char *argv[]) {
+    setlocale(LC_ALL, "rus");
+    std::string only = argc > 1 ? argv[1] : "";
+
+    if (only.empty() || only == "slerp") benchSlerp();
+    if (only.empty() || only == "rotate") benchRotate();
+    if (only.empty() || only == "ellipse") benchEllipseClassify();
+    if (only.empty() || only == "index") benchEllipseIndex();
+    if (only.empty() || only == "perimeter") benchPerimeter();
+    if (only.empty() || only == "compiled") benchCompiledEllipse();
+
+    return 0;
+}
@@ -2,15 +2,617 @@
 #include <vector>
 #include <cmath>
 #include <stdexcept>
+#include <algorithm>
+#include <span>
+#include <string>
+#include <chrono>
+#include <random>
+#include <complex>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <new>
+#include <cstdlib>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <filesystem>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
+// Полином в канонической форме без владения памятью (см. Polynomial):
+// плотная форма - coefficients[i] при x^i и пустой exponents, разреженная - пары
+// coefficients[i] при x^exponents[i]. Указывает на буферы Polynomial или PolynomialPool.
+struct PolynomialView {
+    span<const double> coefficients;
+    span<const int> exponents;
+    bool dense = false;
+
+    size_t termCount() const {
+        if (!dense) return coefficients.size();
+        return coefficients.size() - count(coefficients.begin(), coefficients.end(), 0.0);
+    }
+
+    int degree() const {
+        if (dense) return coefficients.empty() ? 0 : int(coefficients.size()) - 1;
+        return exponents.empty() ? 0 : exponents.back();
+    }
+};
+
 class Polynomial {
 private:
+    // Каноническая форма:
+    //  - разреженная: coefficients[i] при x^exponents[i], степени строго возрастают, нулей нет;
+    //  - плотная: coefficients[i] при x^i, exponents пуст, старший коэффициент ненулевой.
+    // Плотная форма выбирается автоматически, когда ненулевых членов не меньше
+    // denseFillRatio от (степень + 1) и все степени неотрицательны.
     vector<double> coefficients;
     vector<int> exponents;
+    bool dense = false;
+
+    // Приведение разреженных векторов к каноническому виду и выбор формы
+    void canonicalize() {
+        bool sorted = true;
+        for (size_t i = 1; i < exponents.size() && sorted; ++i) {
+            sorted = exponents[i - 1] < exponents[i];
+        }
+        if (!sorted) {
+            vector<size_t> order(exponents.size());
+            for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+            stable_sort(order.begin(), order.end(), [&](size_t x, size_t y) { return exponents[x] < exponents[y]; });
+
+            vector<double> c;
+            vector<int> e;
+            c.reserve(order.size());
+            e.reserve(order.size());
+            for (size_t i : order) {
+                if (!e.empty() && e.back() == exponents[i]) {
+                    c.back() += coefficients[i];
+                } else {
+                    c.push_back(coefficients[i]);
+                    e.push_back(exponents[i]);
+                }
+            }
+            coefficients.swap(c);
+            exponents.swap(e);
+        }
+        dropZeros();
+        chooseForm();
+    }
+
+    // Удаление нулевых членов разреженной формы
+    void dropZeros() {
+        size_t out = 0;
+        for (size_t i = 0; i < coefficients.size(); ++i) {
+            if (coefficients[i] != 0.0) {
+                coefficients[out] = coefficients[i];
+                exponents[out] = exponents[i];
+                ++out;
+            }
+        }
+        coefficients.resize(out);
+        exponents.resize(out);
+    }
+
+    // Переход между формами по коэффициенту заполнения
+    void chooseForm() {
+        if (dense) {
+            while (!coefficients.empty() && coefficients.back() == 0.0) coefficients.pop_back();
+            if (coefficients.empty()) {
+                dense = false;
+                return;
+            }
+            size_t nonZero = coefficients.size() - count(coefficients.begin(), coefficients.end(), 0.0);
+            if (nonZero < denseFillRatio * coefficients.size()) toSparse();
+        } else if (!exponents.empty() && exponents.front() >= 0 &&
+                   coefficients.size() >= denseFillRatio * (double(exponents.back()) + 1)) {
+            toDense();
+        }
+    }
+
+    // Переходы между формами на месте, без новых буферов: при уплотнении коэффициенты
+    // разносятся с конца (степень не меньше номера члена), при разрежении - сжимаются с начала
+    void toDense() {
+        size_t n = coefficients.size();
+        coefficients.resize(exponents.empty() ? 0 : size_t(exponents.back()) + 1, 0.0);
+        for (size_t i = n; i-- > 0;) {
+            double c = coefficients[i];
+            coefficients[i] = 0.0;
+            coefficients[exponents[i]] = c;
+        }
+        exponents.clear();
+        dense = true;
+    }
+
+    void toSparse() {
+        exponents.clear();
+        size_t out = 0;
+        for (size_t i = 0; i < coefficients.size(); ++i) {
+            if (coefficients[i] != 0.0) {
+                coefficients[out++] = coefficients[i];
+                exponents.push_back(int(i));
+            }
+        }
+        coefficients.resize(out);
+        dense = false;
+    }
+
+    // Плотная форма в разреженную со всеми степенями 0..n-1, включая нулевые члены:
+    // сеттеры заменяют один из векторов, и другой должен остаться сопоставленным по номерам
+    void toExplicit() {
+        exponents.resize(coefficients.size());
+        for (size_t i = 0; i < exponents.size(); ++i) exponents[i] = int(i);
+        dense = false;
+    }
+
+    // Сумма this + sign * other за один линейный проход
+    Polynomial combine(const Polynomial& other, double sign) const {
+        Polynomial result;
+        combineInto(view(), other.view(), sign, result);
+        return result;
+    }
+
+    // this += sign * other на месте: плотные складываются в собственный буфер,
+    // в остальных случаях результат слияния переносится в this без копирования
+    Polynomial& accumulate(const Polynomial& other, double sign) {
+        if (dense && other.dense) {
+            if (coefficients.size() < other.coefficients.size()) {
+                coefficients.resize(other.coefficients.size(), 0.0);
+            }
+            for (size_t i = 0; i < other.coefficients.size(); ++i) {
+                coefficients[i] += sign * other.coefficients[i];
+            }
+            chooseForm();
+            return *this;
+        }
+        return *this = combine(other, sign);
+    }
+
+    // Плотная копия с началом в младшей степени: out[i] - коэффициент при x^(i + смещение),
+    // возвращает смещение
+    int spreadTo(vector<double>& out) const {
+        return spread(view(), out);
+    }
+
+    static int spread(PolynomialView v, vector<double>& out) {
+        if (v.dense) {
+            out.assign(v.coefficients.begin(), v.coefficients.end());
+            return 0;
+        }
+        if (v.exponents.empty()) {
+            out.clear();
+            return 0;
+        }
+        int low = v.exponents.front();
+        out.assign(size_t(int64_t(v.exponents.back()) - low) + 1, 0.0);
+        for (size_t i = 0; i < v.coefficients.size(); ++i) out[v.exponents[i] - low] = v.coefficients[i];
+        return low;
+    }
+
+    // Плотные коэффициенты без нулевых младших: p(x) = x^low * (a[0] + a[1] x + ...), a[0] != 0
+    static int spreadTrimmed(PolynomialView v, vector<double>& a) {
+        int low = spread(v, a);
+        size_t zeros = 0;
+        while (zeros < a.size() && a[zeros] == 0.0) ++zeros;
+        a.erase(a.begin(), a.begin() + zeros);
+        return low + int(zeros);
+    }
+
+    // p(x) и p'(x) по схеме Горнера для плотных коэффициентов
+    static void hornerWithDerivative(const vector<double>& a, double x, double& p, double& dp) {
+        p = 0.0;
+        dp = 0.0;
+        for (size_t i = a.size(); i-- > 0;) {
+            dp = dp * x + p;
+            p = p * x + a[i];
+        }
+    }
+
+    // Оценка сверху ошибки округления схемы Горнера в точке x
+    static double hornerErrorBound(const vector<double>& a, double x) {
+        double sum = 0.0, ax = fabs(x);
+        for (size_t i = a.size(); i-- > 0;) sum = sum * ax + fabs(a[i]);
+        return 2.0 * double(a.size()) * numeric_limits<double>::epsilon() * sum;
+    }
+
+    // Поправка Ньютона p(z) / p'(z). При |z| > 1 считается через обратный полином
+    // R(w) = z^-n p(z), w = 1/z: p/p' = z / (n - w R'(w) / R(w)), чтобы степени z
+    // не переполнялись на высоких степенях. atNoise - значение полинома в пределах
+    // ошибки округления схемы Горнера, точнее этот корень уже не уточнить.
+    static complex<double> newtonRatio(const vector<double>& a, complex<double> z, bool& atNoise) {
+        size_t n = a.size() - 1;
+        complex<double> p = 0.0, dp = 0.0;
+        double scale = 0.0;
+        if (abs(z) <= 1.0) {
+            double az = abs(z);
+            for (size_t i = a.size(); i-- > 0;) {
+                dp = dp * z + p;
+                p = p * z + a[i];
+                scale = scale * az + fabs(a[i]);
+            }
+            atNoise = abs(p) <= 4.0 * double(n) * numeric_limits<double>::epsilon() * scale;
+            return p / dp;
+        }
+        complex<double> w = 1.0 / z;
+        double aw = abs(w);
+        for (size_t i = 0; i <= n; ++i) {
+            dp = dp * w + p;
+            p = p * w + a[i];
+            scale = scale * aw + fabs(a[i]);
+        }
+        atNoise = abs(p) <= 4.0 * double(n) * numeric_limits<double>::epsilon() * scale;
+        return z / (double(n) - w * dp / p);
+    }
+
+    // Все комплексные корни методом Аберта-Эрлиха: одновременные итерации Ньютона,
+    // где каждый корень отталкивается от остальных приближений
+    //   z_i -= r / (1 - r * sum_{j != i} 1 / (z_i - z_j)),  r = p(z_i) / p'(z_i).
+    // Начальные точки - на окружности радиуса |a0 / an|^(1/n) (среднее геометрическое
+    // модулей корней). Для простых корней сходимость кубическая. Приближение считается
+    // найденным, когда шаг меньше 4 eps |z| или p(z) неотличим от ошибки округления
+    // (после этого делается еще один, последний шаг). a[0] и a.back() ненулевые.
+    static vector<complex<double>> aberth(const vector<double>& a, int maxIterations) {
+        size_t n = a.size() - 1;
+        if (n == 0) return {};
+        if (n == 1) return {complex<double>(-a[0] / a[1], 0.0)};
+
+        const double pi = acos(-1.0);
+        double radius = pow(fabs(a[0] / a[n]), 1.0 / double(n));
+        vector<complex<double>> z(n);
+        for (size_t k = 0; k < n; ++k) z[k] = polar(radius, 2.0 * pi * double(k) / double(n) + 0.4);
+
+        vector<char> converged(n, 0);
+        const double tolerance = 4.0 * numeric_limits<double>::epsilon();
+        for (int iteration = 0; iteration < maxIterations; ++iteration) {
+            size_t active = 0;
+            for (size_t i = 0; i < n; ++i) {
+                if (converged[i]) continue;
+                bool atNoise;
+                complex<double> ratio = newtonRatio(a, z[i], atNoise);
+                complex<double> repulsion = 0.0;
+                for (size_t j = 0; j < n; ++j) {
+                    if (j != i) repulsion += 1.0 / (z[i] - z[j]);
+                }
+                complex<double> step = ratio / (1.0 - ratio * repulsion);
+                if (!isfinite(step.real()) || !isfinite(step.imag())) {
+                    // p'(z) = 0 или совпадение приближений: небольшой сдвиг и новая попытка
+                    z[i] *= complex<double>(1.0 + 1e-7, 1e-7);
+                    ++active;
+                    continue;
+                }
+                z[i] -= step;
+                if (atNoise || abs(step) <= tolerance * abs(z[i])) converged[i] = 1;
+                else ++active;
+            }
+            if (active == 0) break;
+        }
+        return z;
+    }
+
+    // Корень на отрезке [lo, hi] со сменой знака p(lo) * p(hi) < 0: шаг Ньютона,
+    // если он остается внутри текущей вилки и сокращает ее достаточно быстро, иначе деление
+    // пополам. Вилка сужается на каждом шаге, поэтому метод сходится всегда.
+    static double bracketedNewton(const vector<double>& a, double lo, double hi) {
+        double fLo, dfLo;
+        hornerWithDerivative(a, lo, fLo, dfLo);
+        if (fLo > 0) swap(lo, hi); // далее p(lo) < 0 < p(hi)
+
+        double x = 0.5 * (lo + hi), previousStep = fabs(hi - lo), step = previousStep;
+        for (int iteration = 0; iteration < 200; ++iteration) {
+            double f, df;
+            hornerWithDerivative(a, x, f, df);
+            if (f == 0.0) return x;
+            if (f < 0) lo = x;
+            else hi = x;
+
+            double newton = x - f / df;
+            bool inside = df != 0.0 && (newton - lo) * (newton - hi) < 0.0;
+            if (inside && fabs(2.0 * f) < fabs(previousStep * df)) {
+                previousStep = step;
+                step = f / df;
+                x = newton;
+            } else {
+                previousStep = step;
+                step = 0.5 * (hi - lo);
+                x = lo + step;
+            }
+            if (fabs(step) <= 2.0 * numeric_limits<double>::epsilon() * fabs(x) || lo == hi) return x;
+        }
+        return x;
+    }
+
+    // Вещественные корни на [lo, hi] по возрастанию, без повторов. До realRootsRecursionMax
+    // степени отрезок делится корнями производной на участки монотонности, на каждом не больше
+    // одного корня (ищется в вилке), а кратные корни - это критические точки, где p = 0 в
+    // пределах ошибки округления. Для больших степеней кандидаты берутся из корней Аберта
+    // с малой мнимой частью и уточняются в вилке.
+    static vector<double> realRootsDense(const vector<double>& a, double lo, double hi) {
+        vector<double> result;
+        size_t n = a.size() - 1;
+        auto nearZero = [&](double x) {
+            double f, df;
+            hornerWithDerivative(a, x, f, df);
+            return fabs(f) <= hornerErrorBound(a, x);
+        };
+        // Кратный корень находится с точностью ~eps^(1/кратность) и может прийти с
+        // соседних участков несколькими близкими точками: если p между ними неотличим
+        // от нуля, это один корень, остается точка с меньшим |p|
+        auto addRoot = [&](double x) {
+            if (!result.empty() && (x == result.back() || nearZero(0.5 * (x + result.back())))) {
+                double f, fBack, d;
+                hornerWithDerivative(a, x, f, d);
+                hornerWithDerivative(a, result.back(), fBack, d);
+                if (fabs(f) < fabs(fBack)) result.back() = x;
+                return;
+            }
+            result.push_back(x);
+        };
+
+        if (n == 0) return result;
+        if (n == 1) {
+            double x = -a[0] / a[1];
+            if (lo <= x && x <= hi) result.push_back(x);
+            return result;
+        }
+
+        vector<double> points;
+        if (n <= realRootsRecursionMax) {
+            vector<double> derivative(n);
+            for (size_t i = 1; i <= n; ++i) derivative[i - 1] = a[i] * double(i);
+            points = realRootsDense(derivative, lo, hi);
+        } else {
+            // Кандидаты из комплексных корней (у кратного корня мнимая часть приближения
+            // порядка eps^(1/кратность), поэтому допуск широкий), точки между ними - границы вилок
+            vector<double> candidates;
+            for (const complex<double>& z : aberth(a, 200)) {
+                double x = z.real();
+                if (fabs(z.imag()) <= 1e-3 * (1.0 + fabs(x)) && lo <= x && x <= hi) candidates.push_back(x);
+            }
+            sort(candidates.begin(), candidates.end());
+            candidates.erase(unique(candidates.begin(), candidates.end(),
+                                    [](double x, double y) { return fabs(x - y) <= 1e-12 * (1.0 + fabs(x)); }),
+                             candidates.end());
+            for (size_t i = 0; i < candidates.size(); ++i) {
+                double left = i == 0 ? lo : 0.5 * (candidates[i - 1] + candidates[i]);
+                double right = i + 1 == candidates.size() ? hi : 0.5 * (candidates[i] + candidates[i + 1]);
+                double fl, fr, d;
+                hornerWithDerivative(a, left, fl, d);
+                hornerWithDerivative(a, right, fr, d);
+                if (fl == 0.0) addRoot(left);
+                else if (fr != 0.0 && (fl < 0) != (fr < 0)) addRoot(bracketedNewton(a, left, right));
+                else if (nearZero(candidates[i])) addRoot(candidates[i]); // корень четной кратности
+            }
+            double fHi, d;
+            hornerWithDerivative(a, hi, fHi, d);
+            if (fHi == 0.0) addRoot(hi);
+            return result;
+        }
+
+        points.insert(points.begin(), lo);
+        points.push_back(hi);
+        for (size_t i = 0; i + 1 < points.size(); ++i) {
+            double left = points[i], right = points[i + 1];
+            double fl, fr, d;
+            hornerWithDerivative(a, left, fl, d);
+            hornerWithDerivative(a, right, fr, d);
+            if (i > 0 ? nearZero(left) : fl == 0.0) addRoot(left);
+            else if (fr != 0.0 && (fl < 0) != (fr < 0) && right > left) addRoot(bracketedNewton(a, left, right));
+        }
+        double fHi, d;
+        hornerWithDerivative(a, hi, fHi, d);
+        if (fHi == 0.0) addRoot(hi);
+        return result;
+    }
+
+    // Полином из плотного массива коэффициентов при x^(i + offset)
+    static Polynomial fromDense(vector<double>&& c, int offset) {
+        Polynomial result;
+        if (offset == 0) {
+            result.coefficients = move(c);
+            result.dense = true;
+        } else {
+            for (size_t i = 0; i < c.size(); ++i) {
+                if (c[i] != 0.0) {
+                    result.coefficients.push_back(c[i]);
+                    result.exponents.push_back(int(i) + offset);
+                }
+            }
+        }
+        result.chooseForm();
+        return result;
+    }
+
+    // Произведение разреженных полиномов почленно: n1 * n2 умножений
+    Polynomial multiplyTerms(const Polynomial& other) const {
+        size_t n1 = termCount(), n2 = other.termCount();
+        int low = TermCursor(*this).exponent() + TermCursor(other).exponent();
+        int high = degree() + other.degree();
+        // Если результат заведомо не реже произведений, копим сразу в плотный массив
+        if (size_t(high - low) + 1 <= n1 * n2) {
+            vector<double> c(size_t(high - low) + 1, 0.0);
+            for (TermCursor a(*this); a.valid(); a.next()) {
+                for (TermCursor b(other); b.valid(); b.next()) {
+                    c[a.exponent() + b.exponent() - low] += a.coefficient() * b.coefficient();
+                }
+            }
+            return fromDense(move(c), low);
+        }
+        vector<double> c;
+        vector<int> e;
+        c.reserve(n1 * n2);
+        e.reserve(n1 * n2);
+        for (TermCursor a(*this); a.valid(); a.next()) {
+            for (TermCursor b(other); b.valid(); b.next()) {
+                c.push_back(a.coefficient() * b.coefficient());
+                e.push_back(a.exponent() + b.exponent());
+            }
+        }
+        return Polynomial(c, e);
+    }
+
+    // Умножение в столбик: out[i + j] += a[i] * b[j]
+    static void mulSchoolbook(const double* a, size_t n, const double* b, size_t m, double* out) {
+        for (size_t i = 0; i < n; ++i) {
+            double ai = a[i];
+            for (size_t j = 0; j < m; ++j) out[i + j] += ai * b[j];
+        }
+    }
+
+    // Карацуба для двух массивов длины n: out[0 .. 2n-1) перезаписывается,
+    // scratch - не меньше 5n + 64 элементов
+    static void mulKaratsuba(const double* a, const double* b, size_t n, double* out, double* scratch) {
+        if (n < karatsubaMinTerms) {
+            fill(out, out + 2 * n - 1, 0.0);
+            mulSchoolbook(a, n, b, n, out);
+            return;
+        }
+        // a = a0 + a1 x^k, b = b0 + b1 x^k, длины частей k и h = n - k >= k
+        size_t k = n / 2, h = n - k;
+        double* sa = scratch;
+        double* sb = sa + h;
+        double* z1 = sb + h;
+        double* rest = z1 + 2 * h;
+        for (size_t i = 0; i < h; ++i) {
+            sa[i] = a[k + i] + (i < k ? a[i] : 0.0);
+            sb[i] = b[k + i] + (i < k ? b[i] : 0.0);
+        }
+        mulKaratsuba(sa, sb, h, z1, rest);
+        mulKaratsuba(a, b, k, out, rest);                  // z0 в out[0 .. 2k-1)
+        out[2 * k - 1] = 0.0;
+        mulKaratsuba(a + k, b + k, h, out + 2 * k, rest);  // z2 в out[2k .. 2n-1)
+        // out += (z1 - z0 - z2) x^k
+        for (size_t i = 0; i < 2 * k - 1; ++i) z1[i] -= out[i];
+        for (size_t i = 0; i < 2 * h - 1; ++i) z1[i] -= out[2 * k + i];
+        for (size_t i = 0; i < 2 * h - 1; ++i) out[k + i] += z1[i];
+    }
+
+    // Преобразование Фурье на месте (длина - степень двойки), корни хранятся по уровням:
+    // roots[k + j] = exp(i*pi*j/k) для j < k, считаются в long double, чтобы ошибка
+    // корней не росла с длиной
+    static void fft(vector<complex<double>>& a) {
+        size_t n = a.size();
+        thread_local vector<complex<double>> roots(2, 1.0);
+        thread_local vector<complex<long double>> rootsLong(2, 1.0L);
+        for (size_t k = roots.size(); k < n; k *= 2) {
+            roots.resize(2 * k);
+            rootsLong.resize(2 * k);
+            complex<long double> step = polar(1.0L, acosl(-1.0L) / k);
+            for (size_t i = k; i < 2 * k; ++i) {
+                rootsLong[i] = (i & 1) ? rootsLong[i / 2] * step : rootsLong[i / 2];
+                roots[i] = complex<double>(rootsLong[i]);
+            }
+        }
+        for (size_t i = 1, j = 0; i < n; ++i) {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if (i < j) swap(a[i], a[j]);
+        }
+        double* d = reinterpret_cast<double*>(a.data());
+        const double* w = reinterpret_cast<const double*>(roots.data());
+        for (size_t k = 1; k < n; k *= 2) {
+            for (size_t i = 0; i < n; i += 2 * k) {
+                for (size_t j = 0; j < k; ++j) {
+                    // Комплексное умножение вручную: operator* проверяет inf/nan и не векторизуется
+                    double* x = d + 2 * (i + j);
+                    double* y = d + 2 * (i + j + k);
+                    double wr = w[2 * (j + k)], wi = w[2 * (j + k) + 1];
+                    double zr = wr * y[0] - wi * y[1];
+                    double zi = wr * y[1] + wi * y[0];
+                    y[0] = x[0] - zr;
+                    y[1] = x[1] - zi;
+                    x[0] += zr;
+                    x[1] += zi;
+                }
+            }
+        }
+    }
+
+    // Свертка через БПФ: a и b упаковываются в одну комплексную последовательность a + ib,
+    // тогда A(w)B(w) = (F(w)^2 - conj(F(-w))^2) / 4i, и хватает двух преобразований.
+    // b заранее масштабируется до нормы a, иначе ошибка пропорциональна ||a||^2 + ||b||^2;
+    // при нулевом множителе масштаб не определен, а произведение - нули
+    static vector<double> mulFFT(const vector<double>& a, const vector<double>& b) {
+        size_t resultSize = a.size() + b.size() - 1;
+        double normA = 0.0, normB = 0.0;
+        for (double v : a) normA += v * v;
+        for (double v : b) normB += v * v;
+        if (normA == 0.0 || normB == 0.0) return vector<double>(resultSize, 0.0);
+
+        size_t n = 1;
+        while (n < resultSize) n *= 2;
+        double scale = sqrt(normA / normB);
+
+        vector<complex<double>> in(n), out(n);
+        for (size_t i = 0; i < a.size(); ++i) in[i].real(a[i]);
+        for (size_t i = 0; i < b.size(); ++i) in[i].imag(b[i] * scale);
+        fft(in);
+        for (auto& z : in) z *= z;
+        for (size_t i = 0; i < n; ++i) out[i] = in[-i & (n - 1)] - conj(in[i]);
+        fft(out);
+
+        // out уже отражен (отсчет -w), так что второе прямое преобразование дает обратное
+        vector<double> result(resultSize);
+        double norm = 1.0 / (4.0 * n * scale);
+        for (size_t i = 0; i < resultSize; ++i) result[i] = out[i].imag() * norm;
+        return result;
+    }
 
 public:
+    // Доля ненулевых коэффициентов, начиная с которой хранится плотная форма
+    static constexpr double denseFillRatio = 0.5;
+
+    // Число коэффициентов, начиная с которого evaluate использует схему Эстрина
+    static constexpr size_t estrinMinTerms = 64;
+
+    // Пороги выбора алгоритма умножения по длине меньшего из плотных множителей
+    // (подобраны по polinomialno --bench multiply, x86-64, -O2):
+    // в столбик до karatsubaMinTerms, Карацуба до fftMinTerms, дальше БПФ
+    static constexpr size_t karatsubaMinTerms = 64;
+    static constexpr size_t fftMinTerms = 512;
+
+    enum class MulAlgorithm { AUTO, SCHOOLBOOK, KARATSUBA, FFT };
+
+    // Степень, до которой realRoots делит отрезок корнями производной (рекурсия по
+    // производным стоит O(n^3)); выше кандидаты дает метод Аберта
+    static constexpr size_t realRootsRecursionMax = 24;
+
+    // Обход ненулевых членов по возрастанию степени независимо от формы
+    class TermCursor {
+    private:
+        PolynomialView p;
+        size_t i;
+
+        void skipZeros() {
+            if (p.dense) {
+                while (i < p.coefficients.size() && p.coefficients[i] == 0.0) ++i;
+            }
+        }
+
+    public:
+        explicit TermCursor(PolynomialView poly) : p(poly), i(0) { skipZeros(); }
+        explicit TermCursor(const Polynomial& poly) : TermCursor(poly.view()) {}
+        bool valid() const { return i < p.coefficients.size(); }
+        double coefficient() const { return p.coefficients[i]; }
+        int exponent() const { return p.dense ? int(i) : p.exponents[i]; }
+        void next() {
+            ++i;
+            skipZeros();
+        }
+    };
+
     // Конструкторы
     Polynomial() = default;
 
@@ -20,179 +622,1141 @@ public:
         }
         coefficients = coeffs;
         exponents = exps;
+        canonicalize();
+    }
+
+    // Конструктор, забирающий векторы без копирования
+    Polynomial(vector<double>&& coeffs, vector<int>&& exps) {
+        if (coeffs.size() != exps.size()) {
+            throw invalid_argument("Коэффициенты и экспоненты должны иметь одинаковый размер");
+        }
+        coefficients = move(coeffs);
+        exponents = move(exps);
+        canonicalize();
     }
 
+    // Копия полинома из представления (например, из PolynomialPool)
+    explicit Polynomial(PolynomialView v)
+        : coefficients(v.coefficients.begin(), v.coefficients.end()),
+          exponents(v.exponents.begin(), v.exponents.end()), dense(v.dense) {}
+
     // Конструктор копирования
     Polynomial(const Polynomial& other) {
         coefficients = other.coefficients;
         exponents = other.exponents;
+        dense = other.dense;
+    }
+
+    // Конструктор перемещения: буферы переходят без копирования,
+    // other остается нулевым полиномом
+    Polynomial(Polynomial&& other) noexcept
+        : coefficients(move(other.coefficients)), exponents(move(other.exponents)), dense(other.dense) {
+        other.coefficients.clear();
+        other.exponents.clear();
+        other.dense = false;
+    }
+
+    Polynomial& operator=(const Polynomial& other) = default;
+
+    Polynomial& operator=(Polynomial&& other) noexcept {
+        if (this != &other) {
+            coefficients = move(other.coefficients);
+            exponents = move(other.exponents);
+            dense = other.dense;
+            other.coefficients.clear();
+            other.exponents.clear();
+            other.dense = false;
+        }
+        return *this;
     }
 
     // Деструктор
     ~Polynomial() = default;
 
-    // Сеттеры
+    // Сеттеры (полином приводится к каноническому виду, когда размеры векторов совпадают)
     void setCoefficients(const vector<double>& coeffs) {
+        if (dense) toExplicit();
         coefficients = coeffs;
+        if (coefficients.size() == exponents.size()) canonicalize();
     }
 
     void setExponents(const vector<int>& exps) {
+        if (dense) toExplicit();
         exponents = exps;
+        if (coefficients.size() == exponents.size()) canonicalize();
     }
 
-    // Геттеры
+    // Геттеры (всегда в разреженном виде по возрастанию степени)
     vector<double> getCoefficients() const {
-        return coefficients;
+        if (!dense) return coefficients;
+        vector<double> result;
+        for (TermCursor t(*this); t.valid(); t.next()) result.push_back(t.coefficient());
+        return result;
     }
 
     vector<int> getExponents() const {
+        if (!dense) return exponents;
+        vector<int> result;
+        for (TermCursor t(*this); t.valid(); t.next()) result.push_back(t.exponent());
+        return result;
+    }
+
+    // Коэффициенты и степени в текущей форме хранения без копирования:
+    // в плотной форме coefficientsView()[i] - коэффициент при x^i (возможно нулевой),
+    // а exponentsView() пуст. Действительны до изменения полинома.
+    span<const double> coefficientsView() const {
+        return coefficients;
+    }
+
+    span<const int> exponentsView() const {
         return exponents;
     }
 
+    // Канонический вид полинома без копирования
+    PolynomialView view() const {
+        return PolynomialView{coefficients, exponents, dense};
+    }
+
+    // result = a + sign * b за один линейный проход. Буферы result переиспользуются,
+    // поэтому при повторных вызовах с одним result выделений памяти почти нет.
+    // result не должен быть владельцем a или b.
+    static void combineInto(PolynomialView a, PolynomialView b, double sign, Polynomial& result) {
+        result.coefficients.clear();
+        result.exponents.clear();
+        if (a.dense && b.dense) {
+            result.coefficients.assign(a.coefficients.begin(), a.coefficients.end());
+            result.coefficients.resize(max(a.coefficients.size(), b.coefficients.size()), 0.0);
+            for (size_t i = 0; i < b.coefficients.size(); ++i) {
+                result.coefficients[i] += sign * b.coefficients[i];
+            }
+            result.dense = true;
+            result.chooseForm();
+            return;
+        }
+
+        // Слияние двух отсортированных последовательностей членов
+        result.dense = false;
+        result.coefficients.reserve(a.coefficients.size() + b.coefficients.size());
+        result.exponents.reserve(a.coefficients.size() + b.coefficients.size());
+        TermCursor x(a), y(b);
+        while (x.valid() || y.valid()) {
+            if (!y.valid() || (x.valid() && x.exponent() < y.exponent())) {
+                result.coefficients.push_back(x.coefficient());
+                result.exponents.push_back(x.exponent());
+                x.next();
+            } else if (!x.valid() || y.exponent() < x.exponent()) {
+                result.coefficients.push_back(sign * y.coefficient());
+                result.exponents.push_back(y.exponent());
+                y.next();
+            } else {
+                double c = x.coefficient() + sign * y.coefficient();
+                if (c != 0.0) {
+                    result.coefficients.push_back(c);
+                    result.exponents.push_back(x.exponent());
+                }
+                x.next();
+                y.next();
+            }
+        }
+        result.chooseForm();
+    }
+
+    static Polynomial combine(PolynomialView a, PolynomialView b, double sign) {
+        Polynomial result;
+        combineInto(a, b, sign, result);
+        return result;
+    }
+
+    // Форма хранения и число ненулевых членов
+    bool isDense() const {
+        return dense;
+    }
+
+    size_t termCount() const {
+        if (!dense) return coefficients.size();
+        return coefficients.size() - count(coefficients.begin(), coefficients.end(), 0.0);
+    }
+
     // Определение степени полинома
     int degree() const {
+        if (dense) return coefficients.empty() ? 0 : int(coefficients.size()) - 1;
         if (exponents.empty()) return 0;
-        return *max_element(exponents.begin(), exponents.end());
+        return exponents.back();
     }
 
-    // Вычисление значения полинома для заданного x
+    // Вычисление значения полинома для заданного x:
+    // плотная форма - схема Горнера (Эстрина для высоких степеней),
+    // разреженная - степени x^e получаются из предыдущей домножением на x^(разность степеней)
     double evaluate(double x) const {
-        double result = 0.0;
-        for (size_t i = 0; i < coefficients.size(); ++i) {
-            result += coefficients[i] * pow(x, exponents[i]);
+        if (dense) {
+            return coefficients.size() >= estrinMinTerms ? evaluateEstrin(x) : evaluateHorner(x);
+        }
+        if (coefficients.empty()) return 0.0;
+        double power = powInt(x, exponents[0]);
+        double result = coefficients[0] * power;
+        for (size_t i = 1; i < coefficients.size(); ++i) {
+            power *= powInt(x, exponents[i] - exponents[i - 1]);
+            result += coefficients[i] * power;
         }
         return result;
     }
 
-    // Печать полинома
-    void print() const {
-        if (coefficients.empty()) {
-            cout << "0";
-            return;
+    // Схема Горнера: n умножений и n сложений, одна цепочка зависимостей
+    double evaluateHorner(double x) const {
+        if (!dense) return evaluate(x);
+        double result = 0.0;
+        for (size_t i = coefficients.size(); i-- > 0;) {
+            result = result * x + coefficients[i];
         }
+        return result;
+    }
 
-        for (size_t i = 0; i < coefficients.size(); ++i) {
-            if (i != 0 && coefficients[i] >= 0) {
-                cout << " + ";
-            }
-            else if (i != 0) {
-                cout << " - ";
-            }
-
-            if (exponents[i] == 0) {
-                cout << abs(coefficients[i]);
-            }
-            else {
-                cout << abs(coefficients[i]) << "x^" << exponents[i];
+    // Схема Эстрина: пары коэффициентов сворачиваются независимо (c0 + c1 x, c2 + c3 x, ...),
+    // затем пары пар с x^2, x^4 и т.д. Глубина цепочки log2(n), процессор считает уровни параллельно.
+    double evaluateEstrin(double x) const {
+        if (!dense) return evaluate(x);
+        size_t n = coefficients.size();
+        if (n == 0) return 0.0;
+        if (n == 1) return coefficients[0];
+        // Первый уровень считается прямо из коэффициентов, без их копии
+        thread_local vector<double> buffer;
+        buffer.resize((n + 1) / 2);
+        const double* c = coefficients.data();
+        double* level = buffer.data();
+        size_t pairs = n / 2;
+        for (size_t i = 0; i < pairs; ++i) level[i] = c[2 * i] + c[2 * i + 1] * x;
+        if (n % 2) level[pairs] = c[n - 1];
+        n = buffer.size();
+        double power = x * x;
+        while (n > 1) {
+            size_t half = n / 2;
+            for (size_t i = 0; i < half; ++i) {
+                level[i] = level[2 * i] + level[2 * i + 1] * power;
             }
+            if (n % 2) level[half++] = level[n - 1];
+            n = half;
+            power *= power;
         }
-        cout << endl;
+        return level[0];
     }
 
-    // Оператор сложения полиномов
-    Polynomial operator+(const Polynomial& other) const {
-        vector<double> newCoeffs = coefficients;
-        vector<int> newExps = exponents;
+    // Пакетное вычисление out[j] = p(xs[j]). Точки обрабатываются блоками, внутренний
+    // цикл идет по точкам блока с одинаковым для всех шагом, поэтому компилятор его
+    // векторизует (GCC/Clang: -O3, MSVC: /O2 /arch:AVX2).
+    void evaluate(span<const double> xs, span<double> out) const {
+        if (xs.size() != out.size()) {
+            throw invalid_argument("Размеры входного и выходного массивов должны совпадать");
+        }
+        const size_t block = 256;
+        double power[block], step[block], base[block];
+        for (size_t start = 0; start < xs.size(); start += block) {
+            size_t m = min(block, xs.size() - start);
+            const double* x = xs.data() + start;
+            double* r = out.data() + start;
 
-        for (size_t i = 0; i < other.coefficients.size(); ++i) {
-            bool found = false;
-            for (size_t j = 0; j < newExps.size(); ++j) {
-                if (other.exponents[i] == newExps[j]) {
-                    newCoeffs[j] += other.coefficients[i];
-                    found = true;
-                    break;
+            if (dense) {
+                for (size_t j = 0; j < m; ++j) r[j] = 0.0;
+                for (size_t i = coefficients.size(); i-- > 0;) {
+                    double c = coefficients[i];
+                    for (size_t j = 0; j < m; ++j) r[j] = r[j] * x[j] + c;
                 }
+                continue;
+            }
+
+            for (size_t j = 0; j < m; ++j) {
+                r[j] = 0.0;
+                power[j] = 1.0;
             }
-            if (!found) {
-                newCoeffs.push_back(other.coefficients[i]);
-                newExps.push_back(other.exponents[i]);
+            int previous = 0;
+            for (size_t i = 0; i < coefficients.size(); ++i) {
+                // step = x^(exponents[i] - previous) возведением в квадрат, общим для всего блока
+                int delta = exponents[i] - previous;
+                unsigned e = unsigned(delta < 0 ? -delta : delta);
+                for (size_t j = 0; j < m; ++j) step[j] = 1.0;
+                if (delta < 0) {
+                    for (size_t j = 0; j < m; ++j) base[j] = 1.0 / x[j];
+                } else {
+                    for (size_t j = 0; j < m; ++j) base[j] = x[j];
+                }
+                while (e) {
+                    if (e & 1) {
+                        for (size_t j = 0; j < m; ++j) step[j] *= base[j];
+                    }
+                    e >>= 1;
+                    if (e) {
+                        for (size_t j = 0; j < m; ++j) base[j] *= base[j];
+                    }
+                }
+                double c = coefficients[i];
+                for (size_t j = 0; j < m; ++j) {
+                    power[j] *= step[j];
+                    r[j] += c * power[j];
+                }
+                previous = exponents[i];
             }
         }
-
-        return Polynomial(newCoeffs, newExps);
     }
 
-    // Оператор вычитания полиномов
-    Polynomial operator-(const Polynomial& other) const {
-        vector<double> newCoeffs = coefficients;
-        vector<int> newExps = exponents;
+    // Целая степень возведением в квадрат
+    static double powInt(double x, int e) {
+        unsigned n = unsigned(e < 0 ? -(long long)e : e);
+        double base = e < 0 ? 1.0 / x : x;
+        double result = 1.0;
+        while (n) {
+            if (n & 1) result *= base;
+            base *= base;
+            n >>= 1;
+        }
+        return result;
+    }
 
-        for (size_t i = 0; i < other.coefficients.size(); ++i) {
-            bool found = false;
-            for (size_t j = 0; j < newExps.size(); ++j) {
-                if (other.exponents[i] == newExps[j]) {
-                    newCoeffs[j] -= other.coefficients[i];
-                    found = true;
-                    break;
-                }
+    // Производная: c x^e -> c e x^(e - 1), результат в канонической форме
+    Polynomial derivative() const {
+        Polynomial result;
+        if (dense) {
+            if (coefficients.size() > 1) {
+                result.coefficients.resize(coefficients.size() - 1);
+                for (size_t i = 1; i < coefficients.size(); ++i) result.coefficients[i - 1] = coefficients[i] * double(i);
+                result.dense = true;
             }
-            if (!found) {
-                newCoeffs.push_back(-other.coefficients[i]);
-                newExps.push_back(other.exponents[i]);
+        } else {
+            for (size_t i = 0; i < coefficients.size(); ++i) {
+                if (exponents[i] != 0) {
+                    result.coefficients.push_back(coefficients[i] * exponents[i]);
+                    result.exponents.push_back(exponents[i] - 1);
+                }
             }
         }
+        result.chooseForm();
+        return result;
+    }
 
-        return Polynomial(newCoeffs, newExps);
+    // Первообразная с постоянной constant: c x^e -> c / (e + 1) x^(e + 1).
+    // Для члена x^-1 первообразная - логарифм, это не полином
+    Polynomial antiderivative(double constant = 0.0) const {
+        Polynomial result;
+        if (dense) {
+            result.coefficients.resize(coefficients.size() + 1);
+            result.coefficients[0] = constant;
+            for (size_t i = 0; i < coefficients.size(); ++i) result.coefficients[i + 1] = coefficients[i] / double(i + 1);
+            result.dense = true;
+            result.chooseForm();
+            return result;
+        }
+        for (size_t i = 0; i < coefficients.size(); ++i) {
+            if (exponents[i] == -1) {
+                throw domain_error("Первообразная x^-1 - логарифм, а не полином");
+            }
+            result.coefficients.push_back(coefficients[i] / (exponents[i] + 1));
+            result.exponents.push_back(exponents[i] + 1);
+        }
+        if (constant != 0.0) {
+            result.coefficients.push_back(constant);
+            result.exponents.push_back(0);
+        }
+        result.canonicalize();
+        return result;
     }
-};
 
-class VectPolynomial {
-private:
-    vector<Polynomial> polynomials;
+    // Все комплексные корни с учетом кратности (метод Аберта-Эрлиха), по возрастанию
+    // вещественной, затем мнимой части. Отрицательные степени выносятся множителем x^low:
+    // при low > 0 добавляется корень 0 кратности low, при low < 0 в нуле полюс, а не корень.
+    // У нулевого и ненулевого постоянного полинома корней нет (пустой результат).
+    // Точность ограничена обусловленностью: простой корень - до ошибки округления p
+    // рядом с ним, корень кратности m - порядка eps^(1/m); высокие степени с быстро
+    // растущими коэффициентами (полиномы Чебышева, Уилкинсона) теряют точность в любом методе.
+    static vector<complex<double>> roots(PolynomialView v, int maxIterations = 100) {
+        vector<double> a;
+        int low = spreadTrimmed(v, a);
+        vector<complex<double>> result;
+        if (a.empty()) return result;
+        result = aberth(a, maxIterations);
+        for (int i = 0; i < low; ++i) result.push_back(0.0);
+        sort(result.begin(), result.end(), [](const complex<double>& x, const complex<double>& y) {
+            return x.real() != y.real() ? x.real() < y.real() : x.imag() < y.imag();
+        });
+        return result;
+    }
 
-public:
-    // Добавление полинома в вектор
-    void addPolynomial(const Polynomial& p) {
-        polynomials.push_back(p);
+    vector<complex<double>> roots(int maxIterations = 100) const {
+        return roots(view(), maxIterations);
     }
 
-    // Получение полинома по индексу
-    Polynomial getPolynomial(size_t index) const {
-        if (index >= polynomials.size()) {
-            throw out_of_range("Индекс выходит за границы вектора");
+    // Вещественные корни на отрезке [lo, hi] по возрастанию, каждый один раз
+    // (кратные - тоже один раз); уточнение - метод Ньютона в вилке
+    static vector<double> realRoots(PolynomialView v, double lo, double hi) {
+        if (!(lo <= hi)) throw invalid_argument("Левая граница отрезка больше правой");
+        vector<double> a;
+        int low = spreadTrimmed(v, a);
+        if (a.empty()) return {};
+        vector<double> result = realRootsDense(a, lo, hi);
+        if (low > 0 && lo <= 0.0 && 0.0 <= hi) {
+            result.insert(upper_bound(result.begin(), result.end(), 0.0), 0.0);
         }
-        return polynomials[index];
+        return result;
     }
 
-    // Количество полиномов в векторе
-    size_t size() const {
-        return polynomials.size();
+    vector<double> realRoots(double lo, double hi) const {
+        return realRoots(view(), lo, hi);
     }
 
-    // Обработка полиномов согласно условию задачи
-    static vector<Polynomial> processPolynomials(const VectPolynomial& v1, const VectPolynomial& v2) {
-        if (v1.size() != v2.size()) {
-            throw invalid_argument("Векторы должны быть одинакового размера");
+    // Печать полинома
+    void print() const {
+        if (termCount() == 0) {
+            cout << "0";
+            return;
         }
 
-        vector<Polynomial> result;
-
-        // Обработка нечетных полиномов v1 с четными v2
-        for (size_t i = 0; i < v1.size(); i += 2) {
-            if (i < v1.size() && i + 1 < v2.size()) {
-                result.push_back(v1.getPolynomial(i) + v2.getPolynomial(i + 1));
+        bool first = true;
+        for (TermCursor t(*this); t.valid(); t.next()) {
+            if (!first && t.coefficient() >= 0) {
+                cout << " + ";
             }
-        }
+            else if (!first) {
+                cout << " - ";
+            }
+            first = false;
 
-        // Обработка четных полиномов v1 с нечетными v2
-        for (size_t i = 1; i < v1.size(); i += 2) {
-            if (i < v1.size() && i - 1 < v2.size()) {
-                result.push_back(v1.getPolynomial(i) - v2.getPolynomial(i - 1));
+            if (t.exponent() == 0) {
+                cout << abs(t.coefficient());
+            }
+            else {
+                cout << abs(t.coefficient()) << "x^" << t.exponent();
             }
         }
+        cout << endl;
+    }
 
-        return result;
+    // Оператор сложения полиномов
+    Polynomial operator+(const Polynomial& other) const& {
+        return combine(other, 1.0);
     }
-};
 
-// Функция для создания полинома с вводом от пользователя
-Polynomial createPolynomial() {
-    int degree;
-    cout << "Введите степень полинома: ";
-    cin >> degree;
+    // Временный левый операнд (a + b + c) накапливает результат в своем буфере
+    Polynomial operator+(const Polynomial& other) && {
+        accumulate(other, 1.0);
+        return move(*this);
+    }
 
-    vector<double> coeffs;
-    vector<int> exps;
+    // Оператор вычитания полиномов
+    Polynomial operator-(const Polynomial& other) const& {
+        return combine(other, -1.0);
+    }
+
+    Polynomial operator-(const Polynomial& other) && {
+        accumulate(other, -1.0);
+        return move(*this);
+    }
+
+    // Сложение и вычитание на месте
+    Polynomial& operator+=(const Polynomial& other) {
+        return accumulate(other, 1.0);
+    }
+
+    Polynomial& operator-=(const Polynomial& other) {
+        return accumulate(other, -1.0);
+    }
+
+    // Оператор умножения полиномов
+    Polynomial operator*(const Polynomial& other) const {
+        return multiply(other);
+    }
+
+    Polynomial& operator*=(const Polynomial& other) {
+        return *this = multiply(other);
+    }
+
+    // Умножение с выбором алгоритма. AUTO: разреженные множители перемножаются почленно,
+    // пока это дешевле плотной свертки, плотные - в столбик, Карацубой или через БПФ
+    // по порогам karatsubaMinTerms / fftMinTerms.
+    //
+    // Точность БПФ: коэффициенты результата получаются с абсолютной ошибкой порядка
+    // eps * log2(N) * ||a|| * ||b|| (евклидовы нормы векторов коэффициентов, N - длина
+    // преобразования), а не с относительной ошибкой каждого коэффициента, как в столбик
+    // и у Карацубы. Для коэффициентов из [-1, 1] и степени 10^6 оценка дает ~1e-9,
+    // на практике ошибка ~1e-12 (см. --bench multiply). Поэтому малые коэффициенты
+    // результата, много меньшие ||a|| * ||b||, теряют относительную точность, а точные
+    // нули превращаются в шум того же порядка.
+    // Если это важно, используйте MulAlgorithm::KARATSUBA.
+    Polynomial multiply(const Polynomial& other, MulAlgorithm algorithm = MulAlgorithm::AUTO) const {
+        if (termCount() == 0 || other.termCount() == 0) return Polynomial();
+
+        if (algorithm == MulAlgorithm::AUTO && !(dense && other.dense)) {
+            // Почленно n1 * n2 операций против ~ (s1 + s2) log2(s1 + s2) у плотной свертки
+            // по размаху степеней s; множитель 8 - примерная цена шага БПФ в умножениях
+            double terms = double(termCount()) * other.termCount();
+            double span = double(degree() - TermCursor(*this).exponent()) +
+                          double(other.degree() - TermCursor(other).exponent()) + 2;
+            if (terms <= 8.0 * span * log2(span)) return multiplyTerms(other);
+        }
+
+        vector<double> bufA, bufB;
+        int offset = 0;
+        const vector<double>* a = &coefficients;
+        const vector<double>* b = &other.coefficients;
+        if (!dense) {
+            offset += spreadTo(bufA);
+            a = &bufA;
+        }
+        if (!other.dense) {
+            offset += other.spreadTo(bufB);
+            b = &bufB;
+        }
+        return fromDense(multiplyDense(*a, *b, algorithm), offset);
+    }
+
+    // Свертка плотных массивов коэффициентов
+    static vector<double> multiplyDense(const vector<double>& a, const vector<double>& b,
+                                        MulAlgorithm algorithm = MulAlgorithm::AUTO) {
+        if (a.empty() || b.empty()) return {};
+        const vector<double>& longer = a.size() >= b.size() ? a : b;
+        const vector<double>& shorter = a.size() >= b.size() ? b : a;
+        size_t n = longer.size(), m = shorter.size();
+
+        if (algorithm == MulAlgorithm::AUTO) {
+            if (m < karatsubaMinTerms) algorithm = MulAlgorithm::SCHOOLBOOK;
+            else if (m < fftMinTerms) algorithm = MulAlgorithm::KARATSUBA;
+            else algorithm = MulAlgorithm::FFT;
+        }
+
+        if (algorithm == MulAlgorithm::FFT) return mulFFT(longer, shorter);
+
+        vector<double> result(n + m - 1, 0.0);
+        if (algorithm == MulAlgorithm::SCHOOLBOOK) {
+            mulSchoolbook(longer.data(), n, shorter.data(), m, result.data());
+            return result;
+        }
+
+        // Карацуба для равных длин: длинный множитель режется на куски длины m
+        vector<double> chunk(m), product(2 * m - 1), scratch(5 * m + 64);
+        for (size_t start = 0; start < n; start += m) {
+            size_t len = min(m, n - start);
+            copy(longer.begin() + start, longer.begin() + start + len, chunk.begin());
+            fill(chunk.begin() + len, chunk.end(), 0.0);
+            mulKaratsuba(chunk.data(), shorter.data(), m, product.data(), scratch.data());
+            size_t used = min(product.size(), result.size() - start);
+            for (size_t i = 0; i < used; ++i) result[start + i] += product[i];
+        }
+        return result;
+    }
+};
+
+// Пул полиномов: члены всех полиномов лежат подряд в двух общих буферах
+// (коэффициенты и степени), полином i занимает отрезки
+// [coeffOffsets[i], coeffOffsets[i + 1]) и [expOffsets[i], expOffsets[i + 1]).
+// Миллион полиномов - это пять массивов вместо двух миллионов отдельных векторов,
+// полиномы идут в памяти в порядке добавления, а clear() освобождает весь пул
+// за O(1) (буферы тривиальных типов, память остается для повторного заполнения).
+class PolynomialPool {
+private:
+    vector<double> coefficients;
+    vector<int> exponents;
+    vector<size_t> coeffOffsets{0};
+    vector<size_t> expOffsets{0};
+    vector<char> denseFlags;
+
+public:
+    PolynomialPool() = default;
+
+    // Резервирование под polynomials полиномов и terms членов
+    void reserve(size_t polynomials, size_t terms) {
+        coefficients.reserve(terms);
+        exponents.reserve(terms);
+        coeffOffsets.reserve(polynomials + 1);
+        expOffsets.reserve(polynomials + 1);
+        denseFlags.reserve(polynomials);
+    }
+
+    // Добавление полинома в канонической форме (из Polynomial или другого пула)
+    void add(PolynomialView v) {
+        coefficients.insert(coefficients.end(), v.coefficients.begin(), v.coefficients.end());
+        exponents.insert(exponents.end(), v.exponents.begin(), v.exponents.end());
+        coeffOffsets.push_back(coefficients.size());
+        expOffsets.push_back(exponents.size());
+        denseFlags.push_back(v.dense);
+    }
+
+    void add(const Polynomial& p) {
+        add(p.view());
+    }
+
+    // Добавление всех полиномов другого пула одним копированием буферов
+    void append(const PolynomialPool& other) {
+        size_t coeffBase = coefficients.size(), expBase = exponents.size();
+        coefficients.insert(coefficients.end(), other.coefficients.begin(), other.coefficients.end());
+        exponents.insert(exponents.end(), other.exponents.begin(), other.exponents.end());
+        for (size_t i = 1; i < other.coeffOffsets.size(); ++i) {
+            coeffOffsets.push_back(coeffBase + other.coeffOffsets[i]);
+            expOffsets.push_back(expBase + other.expOffsets[i]);
+        }
+        denseFlags.insert(denseFlags.end(), other.denseFlags.begin(), other.denseFlags.end());
+    }
+
+    // Полином по индексу без копирования (индекс не проверяется)
+    PolynomialView operator[](size_t index) const {
+        size_t c = coeffOffsets[index], e = expOffsets[index];
+        return PolynomialView{span<const double>(coefficients.data() + c, coeffOffsets[index + 1] - c),
+                              span<const int>(exponents.data() + e, expOffsets[index + 1] - e),
+                              denseFlags[index] != 0};
+    }
+
+    size_t size() const {
+        return denseFlags.size();
+    }
+
+    // Общее число хранимых коэффициентов
+    size_t termStorage() const {
+        return coefficients.size();
+    }
+
+    // Удаление всех полиномов за O(1) с сохранением памяти
+    void clear() {
+        coefficients.clear();
+        exponents.clear();
+        coeffOffsets.resize(1);
+        expOffsets.resize(1);
+        denseFlags.clear();
+    }
+
+    // Удаление всех полиномов с возвратом памяти системе (пять освобождений)
+    void release() {
+        PolynomialPool().swap(*this);
+    }
+
+    void swap(PolynomialPool& other) noexcept {
+        coefficients.swap(other.coefficients);
+        exponents.swap(other.exponents);
+        coeffOffsets.swap(other.coeffOffsets);
+        expOffsets.swap(other.expOffsets);
+        denseFlags.swap(other.denseFlags);
+    }
+};
+
+// ===== Двоичный файл вектора полиномов =====
+//
+// Формат (все поля в порядке байт машины-писателя, смещения от начала файла):
+//   заголовок PolynomialFileHeader, 64 байта;
+//   записи полиномов подряд, каждая с адреса, кратного 8:
+//     коэффициенты - terms double, затем для разреженной формы степени - terms int32,
+//     дополнение нулями до кратного 8;
+//   таблица PolynomialFileEntry[count] с адреса tableOffset.
+// Таблица пишется в конце, поэтому писатель не знает заранее число полиномов и пишет
+// потоком. Полиномы хранятся в канонической форме Polynomial (плотная или разреженная),
+// так что загрузчик отдает их как PolynomialView прямо из отображенной памяти.
+struct PolynomialFileHeader {
+    char magic[8];           // "POLYVEC\0"
+    uint32_t version;        // 1
+    uint32_t byteOrder;      // 0x01020304 в порядке байт писателя
+    uint64_t count;          // число полиномов
+    uint64_t tableOffset;    // смещение таблицы записей
+    uint64_t fileSize;       // полный размер файла (защита от обрезанных файлов)
+    uint64_t reserved[3];
+};
+
+struct PolynomialFileEntry {
+    uint64_t offset;         // смещение записи
+    uint32_t terms;          // число коэффициентов
+    uint32_t dense;          // 1 - плотная форма (степеней нет)
+};
+
+static_assert(sizeof(PolynomialFileHeader) == 64, "заголовок файла должен занимать 64 байта");
+static_assert(sizeof(PolynomialFileEntry) == 16, "запись таблицы должна занимать 16 байт");
+
+constexpr char polynomialFileMagic[8] = {'P', 'O', 'L', 'Y', 'V', 'E', 'C', '\0'};
+constexpr uint32_t polynomialFileVersion = 1;
+constexpr uint32_t polynomialFileByteOrder = 0x01020304;
+
+// Потоковая запись полиномов в файл: записи идут сразу на диск, в памяти держится
+// только таблица (16 байт на полином). close() дописывает таблицу и заголовок;
+// деструктор этого не делает, так что файл без close() (например, писатель
+// уничтожен при исключении) остается с нулевым заголовком и загрузчик его отвергнет.
+class PolynomialFileWriter {
+private:
+    ofstream out;
+    vector<PolynomialFileEntry> table;
+    uint64_t position = sizeof(PolynomialFileHeader);
+    bool closed = false;
+
+    void writeBytes(const void* data, size_t size) {
+        out.write(static_cast<const char*>(data), streamsize(size));
+        position += size;
+    }
+
+    void pad() {
+        static const char zeros[8] = {};
+        if (position % 8) writeBytes(zeros, 8 - position % 8);
+    }
+
+public:
+    explicit PolynomialFileWriter(const string& path) : out(path, ios::binary | ios::trunc) {
+        if (!out) throw runtime_error("Не удалось открыть файл для записи: " + path);
+        PolynomialFileHeader header{};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    PolynomialFileWriter(const PolynomialFileWriter&) = delete;
+    PolynomialFileWriter& operator=(const PolynomialFileWriter&) = delete;
+
+    void write(PolynomialView v) {
+        if (closed) throw logic_error("Запись в закрытый файл полиномов");
+        if (v.coefficients.size() > UINT32_MAX) throw length_error("Полином слишком длинный для файла полиномов");
+        table.push_back(PolynomialFileEntry{position, uint32_t(v.coefficients.size()), v.dense ? 1u : 0u});
+        writeBytes(v.coefficients.data(), v.coefficients.size_bytes());
+        writeBytes(v.exponents.data(), v.exponents.size_bytes());
+        pad();
+    }
+
+    void write(const Polynomial& p) {
+        write(p.view());
+    }
+
+    size_t size() const {
+        return table.size();
+    }
+
+    void close() {
+        if (closed) return;
+        closed = true;
+        PolynomialFileHeader header{};
+        memcpy(header.magic, polynomialFileMagic, sizeof(header.magic));
+        header.version = polynomialFileVersion;
+        header.byteOrder = polynomialFileByteOrder;
+        header.count = table.size();
+        header.tableOffset = position;
+        writeBytes(table.data(), table.size() * sizeof(PolynomialFileEntry));
+        header.fileSize = position;
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.close();
+        if (!out) throw runtime_error("Ошибка записи файла полиномов");
+    }
+};
+
+// Файл полиномов, отображенный в память только для чтения. Открытие проверяет
+// заголовок и каждую запись таблицы: запись лежит между заголовком и таблицей,
+// степени разреженной записи строго возрастают (на этом держатся spread и все
+// алгоритмы над PolynomialView), поэтому степени читаются один раз целиком, а
+// коэффициенты подгружаются по мере обращения. operator[] отдает полином без копирования и
+// без проверки индекса; at() дополнительно проверяет индекс.
+class MappedPolynomialFile {
+private:
+    const unsigned char* data = nullptr;
+    size_t length = 0;
+    const PolynomialFileEntry* table = nullptr;
+    size_t count = 0;
+
+    void unmap() {
+        if (!data) return;
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+#else
+        munmap(const_cast<unsigned char*>(data), length);
+#endif
+        data = nullptr;
+    }
+
+    void map(const string& path) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw runtime_error("Не удалось открыть файл: " + path);
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+        length = size_t(fileSize.QuadPart);
+        HANDLE mapping = length ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+        CloseHandle(file);
+        if (mapping) {
+            data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw runtime_error("Не удалось открыть файл: " + path);
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw runtime_error("Не удалось узнать размер файла: " + path);
+        }
+        length = size_t(st.st_size);
+        if (length) {
+            void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data = static_cast<const unsigned char*>(p);
+                // processPolynomials читает записи по порядку
+                madvise(p, length, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+#endif
+        if (!data && length) throw runtime_error("Не удалось отобразить файл в память: " + path);
+    }
+
+public:
+    explicit MappedPolynomialFile(const string& path) {
+        map(path);
+        PolynomialFileHeader header;
+        if (length < sizeof(header)) {
+            unmap();
+            throw runtime_error("Файл полиномов слишком короткий: " + path);
+        }
+        memcpy(&header, data, sizeof(header));
+        const char* problem = nullptr;
+        if (memcmp(header.magic, polynomialFileMagic, sizeof(header.magic)) != 0) problem = "неверная сигнатура";
+        else if (header.version != polynomialFileVersion) problem = "неподдерживаемая версия";
+        else if (header.byteOrder != polynomialFileByteOrder) problem = "другой порядок байт";
+        else if (header.fileSize != length) problem = "размер не совпадает с заголовком (файл обрезан или не закрыт)";
+        else if (header.tableOffset % 8 || header.tableOffset > length ||
+                 header.count > (length - header.tableOffset) / sizeof(PolynomialFileEntry)) problem = "таблица за границей файла";
+        if (problem) {
+            unmap();
+            throw runtime_error(string("Поврежденный файл полиномов (") + problem + "): " + path);
+        }
+        table = reinterpret_cast<const PolynomialFileEntry*>(data + header.tableOffset);
+        count = size_t(header.count);
+        for (size_t i = 0; i < count; ++i) {
+            const PolynomialFileEntry& e = table[i];
+            uint64_t bytes = uint64_t(e.terms) * (e.dense ? sizeof(double) : sizeof(double) + sizeof(int));
+            if (e.offset % 8 || e.offset < sizeof(PolynomialFileHeader) || e.offset > header.tableOffset ||
+                bytes > header.tableOffset - e.offset) {
+                unmap();
+                throw runtime_error("Поврежденный файл полиномов (запись " + to_string(i) + " за границей данных): " + path);
+            }
+            if (e.dense) continue;
+            const int* x = reinterpret_cast<const int*>(data + e.offset + uint64_t(e.terms) * sizeof(double));
+            for (uint32_t k = 1; k < e.terms; ++k) {
+                if (x[k - 1] >= x[k]) {
+                    unmap();
+                    throw runtime_error("Поврежденный файл полиномов (степени записи " + to_string(i) +
+                                        " не возрастают): " + path);
+                }
+            }
+        }
+    }
+
+    MappedPolynomialFile(const MappedPolynomialFile&) = delete;
+    MappedPolynomialFile& operator=(const MappedPolynomialFile&) = delete;
+
+    ~MappedPolynomialFile() {
+        unmap();
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    // Полином по индексу без копирования (индекс не проверяется)
+    PolynomialView operator[](size_t index) const {
+        const PolynomialFileEntry& e = table[index];
+        const double* c = reinterpret_cast<const double*>(data + e.offset);
+        const int* x = reinterpret_cast<const int*>(c + e.terms);
+        return PolynomialView{span<const double>(c, e.terms), span<const int>(x, e.dense ? 0 : e.terms), e.dense != 0};
+    }
+
+    // То же с проверкой индекса
+    PolynomialView at(size_t index) const {
+        if (index >= count) throw out_of_range("Индекс выходит за границы файла полиномов");
+        return (*this)[index];
+    }
+};
+
+class VectPolynomial {
+public:
+    // Хранение: OBJECTS - вектор самостоятельных Polynomial,
+    // POOL - общий PolynomialPool для больших наборов мелких полиномов,
+    // MAPPED - файл, отображенный в память (только чтение, см. load)
+    enum class Storage { OBJECTS, POOL, MAPPED };
+
+private:
+    Storage storage;
+    vector<Polynomial> polynomials;
+    PolynomialPool pool;
+    shared_ptr<const MappedPolynomialFile> file;
+
+    void requireWritable() const {
+        if (storage == Storage::MAPPED) throw logic_error("Вектор, загруженный из файла, доступен только для чтения");
+    }
+
+    // Пулы parts[c] получают полиномы k из куска c диапазона [from, to):
+    // v1[2k] + v2[2k + 1] при sign > 0 и v1[2k + 1] - v2[2k] при sign < 0
+    static void combineRange(const VectPolynomial& v1, const VectPolynomial& v2, size_t from, size_t to,
+                             double sign, unsigned threads, vector<PolynomialPool>& parts) {
+        size_t chunks = (to - from + processChunk - 1) / processChunk;
+        parts.resize(chunks);
+        parallelChunks(to - from, processChunk, threads, [&](size_t begin, size_t end) {
+            Polynomial scratch;
+            for (size_t c = begin / processChunk; c * processChunk < end; ++c) {
+                size_t first = from + max(begin, c * processChunk), last = from + min(end, (c + 1) * processChunk);
+                size_t terms = 0;
+                for (size_t k = first; k < last; ++k) {
+                    terms += max(v1.at(2 * k).coefficients.size(), v2.at(2 * k + 1).coefficients.size());
+                }
+                parts[c].clear();
+                parts[c].reserve(last - first, terms);
+                for (size_t k = first; k < last; ++k) {
+                    if (sign > 0) Polynomial::combineInto(v1.at(2 * k), v2.at(2 * k + 1), 1.0, scratch);
+                    else Polynomial::combineInto(v1.at(2 * k + 1), v2.at(2 * k), -1.0, scratch);
+                    parts[c].add(scratch);
+                }
+            }
+        });
+    }
+
+    // Выполняет body(begin, end) над кусками [0, n) длины chunk в threads потоках.
+    // Куски раздаются через общий счетчик: освободившийся поток берет следующий,
+    // так что потоки с тяжелыми полиномами не задерживают остальные.
+    // Первое исключение из body пробрасывается вызывающему после остановки потоков.
+    template <typename Body>
+    static void parallelChunks(size_t n, size_t chunk, unsigned threads, Body body) {
+        size_t chunks = (n + chunk - 1) / chunk;
+        if (threads > chunks) threads = unsigned(chunks);
+        if (threads <= 1) {
+            body(size_t(0), n);
+            return;
+        }
+
+        atomic<size_t> next(0);
+        atomic<bool> failed(false);
+        exception_ptr error;
+        auto worker = [&] {
+            size_t c;
+            while (!failed.load(memory_order_relaxed) && (c = next.fetch_add(1, memory_order_relaxed)) < chunks) {
+                try {
+                    body(c * chunk, min(n, (c + 1) * chunk));
+                } catch (...) {
+                    if (!failed.exchange(true)) error = current_exception();
+                }
+            }
+        };
+        vector<thread> workers;
+        workers.reserve(threads - 1);
+        for (unsigned t = 1; t < threads; ++t) workers.emplace_back(worker);
+        worker();
+        for (auto& t : workers) t.join();
+        if (error) rethrow_exception(error);
+    }
+
+public:
+    // Число пар, обрабатываемых одним потоком за раз в processPolynomials
+    static constexpr size_t processChunk = 256;
+
+    explicit VectPolynomial(Storage mode = Storage::OBJECTS) : storage(mode) {}
+
+    Storage getStorage() const {
+        return storage;
+    }
+
+    // Добавление полинома в вектор
+    void addPolynomial(const Polynomial& p) {
+        requireWritable();
+        if (storage == Storage::POOL) pool.add(p);
+        else polynomials.push_back(p);
+    }
+
+    void addPolynomial(Polynomial&& p) {
+        requireWritable();
+        if (storage == Storage::POOL) pool.add(p);
+        else polynomials.push_back(move(p));
+    }
+
+    // Создание полинома прямо в хранилище из аргументов конструктора Polynomial
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        requireWritable();
+        if (storage == Storage::POOL) pool.add(Polynomial(forward<Args>(args)...));
+        else polynomials.emplace_back(forward<Args>(args)...);
+    }
+
+    // Резервирование под n полиномов (в режиме POOL - и под terms членов)
+    void reserve(size_t n, size_t terms = 0) {
+        requireWritable();
+        if (storage == Storage::POOL) pool.reserve(n, terms);
+        else polynomials.reserve(n);
+    }
+
+    // Получение полинома по индексу
+    Polynomial getPolynomial(size_t index) const {
+        if (index >= size()) {
+            throw out_of_range("Индекс выходит за границы вектора");
+        }
+        if (storage == Storage::POOL) return Polynomial(pool[index]);
+        if (storage == Storage::MAPPED) return Polynomial(file->at(index));
+        return polynomials[index];
+    }
+
+    // Полином без копирования в любом режиме хранения (индекс не проверяется)
+    PolynomialView at(size_t index) const {
+        switch (storage) {
+        case Storage::POOL:
+            return pool[index];
+        case Storage::MAPPED:
+            return (*file)[index];
+        default:
+            return polynomials[index].view();
+        }
+    }
+
+    // Доступ к объекту Polynomial без копирования (индекс не проверяется). Только
+    // OBJECTS: в POOL и MAPPED объектов Polynomial нет, там - at() или getPolynomial()
+    const Polynomial& operator[](size_t index) const {
+        if (storage != Storage::OBJECTS) throw logic_error("operator[] доступен только при хранении OBJECTS");
+        return polynomials[index];
+    }
+
+    // Все полиномы без копирования (только OBJECTS, в режимах POOL и MAPPED пусто -
+    // см. getPool и at)
+    span<const Polynomial> view() const {
+        return polynomials;
+    }
+
+    const PolynomialPool& getPool() const {
+        return pool;
+    }
+
+    // Количество полиномов в векторе
+    size_t size() const {
+        switch (storage) {
+        case Storage::POOL:
+            return pool.size();
+        case Storage::MAPPED:
+            return file ? file->size() : 0;
+        default:
+            return polynomials.size();
+        }
+    }
+
+    // Удаление всех полиномов; в режиме POOL - за O(1), в режиме MAPPED
+    // отображение снимается, когда его не держит ни одна копия вектора
+    void clear() {
+        polynomials.clear();
+        pool.clear();
+        file.reset();
+    }
+
+    // Обработка полиномов согласно условию задачи:
+    // сначала v1[i] + v2[i + 1] для четных i, затем v1[i] - v2[i - 1] для нечетных.
+    // Пара номер k дает result[k] и result[half + k] независимо от остальных, поэтому
+    // пары делятся между threads потоками (0 - по числу ядер), а порядок результата
+    // совпадает с последовательной обработкой.
+    static vector<Polynomial> processPolynomials(const VectPolynomial& v1, const VectPolynomial& v2,
+                                                 unsigned threads = 0) {
+        if (v1.size() != v2.size()) {
+            throw invalid_argument("Векторы должны быть одинакового размера");
+        }
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+
+        size_t half = v1.size() / 2;
+        vector<Polynomial> result(2 * half);
+        parallelChunks(half, processChunk, threads, [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                // Обработка нечетных полиномов v1 с четными v2
+                result[k] = Polynomial::combine(v1.at(2 * k), v2.at(2 * k + 1), 1.0);
+                // Обработка четных полиномов v1 с нечетными v2
+                result[half + k] = Polynomial::combine(v1.at(2 * k + 1), v2.at(2 * k), -1.0);
+            }
+        });
+
+        return result;
+    }
+
+    // То же с результатом в пуле (Storage::POOL) в том же порядке. Каждый кусок пар
+    // пишет в свои два пула через один переиспользуемый Polynomial, затем пулы
+    // склеиваются по порядку кусков. Для входов в режиме POOL соседние пары лежат
+    // в памяти подряд, и обработка идет по буферам последовательно.
+    static VectPolynomial processPolynomialsPooled(const VectPolynomial& v1, const VectPolynomial& v2,
+                                                   unsigned threads = 0) {
+        if (v1.size() != v2.size()) {
+            throw invalid_argument("Векторы должны быть одинакового размера");
+        }
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+
+        size_t half = v1.size() / 2;
+        vector<PolynomialPool> sums, differences;
+        combineRange(v1, v2, 0, half, 1.0, threads, sums);
+        combineRange(v1, v2, 0, half, -1.0, threads, differences);
+
+        VectPolynomial result(Storage::POOL);
+        size_t terms = 0;
+        for (const PolynomialPool& part : sums) terms += part.termStorage();
+        for (const PolynomialPool& part : differences) terms += part.termStorage();
+        result.pool.reserve(2 * half, terms);
+        for (const PolynomialPool& part : sums) result.pool.append(part);
+        for (const PolynomialPool& part : differences) result.pool.append(part);
+        return result;
+    }
+
+    // То же с потоковой записью результата в файл: пары обрабатываются блоками
+    // по processFileBlock, блок считается параллельно и сразу пишется по порядку,
+    // так что в памяти держится один блок результатов, а не весь вектор
+    static constexpr size_t processFileBlock = 64 * processChunk;
+
+    static void processPolynomials(const VectPolynomial& v1, const VectPolynomial& v2,
+                                   PolynomialFileWriter& out, unsigned threads = 0) {
+        if (v1.size() != v2.size()) {
+            throw invalid_argument("Векторы должны быть одинакового размера");
+        }
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+
+        size_t half = v1.size() / 2;
+        vector<PolynomialPool> parts;
+        for (double sign : {1.0, -1.0}) {
+            for (size_t from = 0; from < half; from += processFileBlock) {
+                combineRange(v1, v2, from, min(half, from + processFileBlock), sign, threads, parts);
+                for (const PolynomialPool& part : parts) {
+                    for (size_t i = 0; i < part.size(); ++i) out.write(part[i]);
+                }
+            }
+        }
+    }
+
+    // Корни всех полиномов вектора (см. Polynomial::roots) в threads потоках (0 - по
+    // числу ядер); result[i] - корни i-го полинома. Полиномы раздаются кусками по
+    // rootsChunk: время на полином сильно зависит от степени
+    static constexpr size_t rootsChunk = 16;
+
+    vector<vector<complex<double>>> roots(unsigned threads = 0) const {
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+        vector<vector<complex<double>>> result(size());
+        parallelChunks(size(), rootsChunk, threads, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) result[i] = Polynomial::roots(at(i));
+        });
+        return result;
+    }
+
+    // Вещественные корни всех полиномов на [lo, hi] (см. Polynomial::realRoots)
+    vector<vector<double>> realRoots(double lo, double hi, unsigned threads = 0) const {
+        if (!(lo <= hi)) throw invalid_argument("Левая граница отрезка больше правой");
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+        vector<vector<double>> result(size());
+        parallelChunks(size(), rootsChunk, threads, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) result[i] = Polynomial::realRoots(at(i), lo, hi);
+        });
+        return result;
+    }
+
+    // Запись всех полиномов в двоичный файл (формат - см. PolynomialFileHeader)
+    void save(const string& path) const {
+        PolynomialFileWriter out(path);
+        for (size_t i = 0; i < size(); ++i) out.write(at(i));
+        out.close();
+    }
+
+    // Вектор поверх файла, отображенного в память (Storage::MAPPED): полиномы не
+    // читаются и не копируются, копии вектора разделяют одно отображение
+    static VectPolynomial load(const string& path) {
+        VectPolynomial result(Storage::MAPPED);
+        result.file = make_shared<const MappedPolynomialFile>(path);
+        return result;
+    }
+};
+
+// Функция для создания полинома с вводом от пользователя
+Polynomial createPolynomial() {
+    int degree;
+    cout << "Введите степень полинома: ";
+    cin >> degree;
+
+    vector<double> coeffs;
+    vector<int> exps;
 
     for (int i = 0; i <= degree; ++i) {
         double coeff;
@@ -202,12 +1766,645 @@ Polynomial createPolynomial() {
         exps.push_back(i);
     }
 
-    return Polynomial(coeffs, exps);
+    return Polynomial(move(coeffs), move(exps));
+}
+
+// ===== Бенчмарки (запуск: polinomialno --bench [раздел]) =====
+
+// Счетчик выделений памяти для раздела alloc - только в сборке с
+// -DPOLYNOMIAL_COUNT_ALLOCATIONS: глобальный operator new заменяется на malloc
+// со счетчиком, остальные формы new/delete сводятся к этим. В обычной сборке
+// раздел alloc выводит только время
+#ifdef POLYNOMIAL_COUNT_ALLOCATIONS
+atomic<size_t> allocationCount(0);
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
 }
 
-int main() {
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+// GCC сверяет пары new/delete после встраивания и не видит, что new выше тоже malloc
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, const nothrow_t&) noexcept {
+    free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+// Среднее время одного повтора функции f, нс
+template <typename F>
+double measureNs(F f, int repeats) {
+    f(); // прогрев
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) f();
+    auto stop = chrono::steady_clock::now();
+    return chrono::duration<double, nano>(stop - start).count() / repeats;
+}
+
+// Случайный полином из terms членов со степенями из [0, maxExp]
+Polynomial randomPolynomial(mt19937& gen, size_t terms, int maxExp) {
+    uniform_real_distribution<double> coeff(-1.0, 1.0);
+    uniform_int_distribution<int> exp(0, maxExp);
+    vector<double> c(terms);
+    vector<int> e(terms);
+    for (size_t i = 0; i < terms; ++i) {
+        c[i] = coeff(gen);
+        e[i] = exp(gen);
+    }
+    return Polynomial(c, e);
+}
+
+void benchEvaluate() {
+    cout << "== evaluate ==" << endl;
+    mt19937 gen(1);
+    const size_t points = 1 << 20;
+    vector<double> xs(points), out(points);
+    uniform_real_distribution<double> xDist(-1.0, 1.0);
+    for (auto& x : xs) x = xDist(gen);
+
+    struct Case {
+        const char* name;
+        Polynomial p;
+    } cases[] = {
+        {"плотный, степень 16", randomPolynomial(gen, 64, 16)},
+        {"плотный, степень 256", randomPolynomial(gen, 1024, 256)},
+        {"разреженный, 16 членов до x^1000", randomPolynomial(gen, 16, 1000)},
+    };
+
+    for (const Case& c : cases) {
+        vector<double> coeffs = c.p.getCoefficients();
+        vector<int> exps = c.p.getExponents();
+        size_t n = 1 << 14;
+        double sink = 0;
+
+        // Исходный способ: pow на каждый член
+        double naive = measureNs([&] {
+            for (size_t j = 0; j < n; ++j) {
+                double r = 0;
+                for (size_t i = 0; i < coeffs.size(); ++i) r += coeffs[i] * pow(xs[j], exps[i]);
+                sink += r;
+            }
+        }, 3) / n;
+        double single = measureNs([&] {
+            for (size_t j = 0; j < n; ++j) sink += c.p.evaluate(xs[j]);
+        }, 3) / n;
+        double batch = measureNs([&] { c.p.evaluate(span<const double>(xs), span<double>(out)); }, 3) / points;
+
+        double err = 0;
+        for (size_t j = 0; j < 1000; ++j) {
+            double r = 0;
+            for (size_t i = 0; i < coeffs.size(); ++i) r += coeffs[i] * pow(xs[j], exps[i]);
+            err = max(err, fabs(out[j] - r));
+        }
+
+        cout << c.name << (c.p.isDense() ? " (dense)" : " (sparse)") << ":" << endl;
+        cout << "  pow по членам: " << naive << " нс/точку" << endl;
+        cout << "  evaluate(x):   " << single << " нс/точку (x" << naive / single << ")" << endl;
+        if (c.p.isDense()) {
+            double horner = measureNs([&] {
+                for (size_t j = 0; j < n; ++j) sink += c.p.evaluateHorner(xs[j]);
+            }, 3) / n;
+            double estrin = measureNs([&] {
+                for (size_t j = 0; j < n; ++j) sink += c.p.evaluateEstrin(xs[j]);
+            }, 3) / n;
+            cout << "  Горнер:        " << horner << " нс/точку" << endl;
+            cout << "  Эстрин:        " << estrin << " нс/точку" << endl;
+        }
+        cout << "  пакетом:       " << batch << " нс/точку (x" << naive / batch << "), max ошибка " << err << endl;
+        if (sink == 42) cout << "";
+    }
+    cout << endl;
+}
+
+// Плотный полином степени n - 1 со случайными коэффициентами из [-1, 1]
+Polynomial densePolynomial(mt19937& gen, size_t n) {
+    uniform_real_distribution<double> coeff(-1.0, 1.0);
+    vector<double> c(n);
+    vector<int> e(n);
+    for (size_t i = 0; i < n; ++i) {
+        c[i] = coeff(gen);
+        e[i] = int(i);
+    }
+    return Polynomial(c, e);
+}
+
+void benchMultiply() {
+    cout << "== multiply ==" << endl;
+    mt19937 gen(2);
+    using Alg = Polynomial::MulAlgorithm;
+
+    // Время каждого алгоритма на плотных множителях одинаковой длины, точки переключения
+    size_t sizes[] = {8, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 2048, 4096, 16384, 65536};
+    size_t karatsubaFrom = 0, fftFrom = 0;
+    cout << "длина      столбик, мкс   Карацуба, мкс   БПФ, мкс" << endl;
+    for (size_t n : sizes) {
+        vector<double> a = densePolynomial(gen, n).getCoefficients();
+        vector<double> b = densePolynomial(gen, n).getCoefficients();
+        int repeats = int(max<size_t>(1, 4000000 / (n * n / 8 + n * 20)));
+        auto timeOf = [&](Alg alg) {
+            return measureNs([&] { Polynomial::multiplyDense(a, b, alg); }, repeats) / 1000;
+        };
+        double school = n <= 16384 ? timeOf(Alg::SCHOOLBOOK) : 0;
+        double kara = timeOf(Alg::KARATSUBA);
+        double fftTime = timeOf(Alg::FFT);
+        // Порог - длина, начиная с которой алгоритм выигрывает на всех следующих размерах
+        if (school) karatsubaFrom = kara < school ? (karatsubaFrom ? karatsubaFrom : n) : 0;
+        fftFrom = fftTime < kara ? (fftFrom ? fftFrom : n) : 0;
+        cout << n << "\t   " << school << "\t  " << kara << "\t  " << fftTime << endl;
+    }
+    cout << "Карацуба быстрее столбика с длины " << karatsubaFrom << " (karatsubaMinTerms = "
+         << Polynomial::karatsubaMinTerms << ")" << endl;
+    cout << "БПФ быстрее Карацубы с длины " << fftFrom << " (fftMinTerms = "
+         << Polynomial::fftMinTerms << ")" << endl;
+
+    // Ошибка БПФ относительно ||a|| * ||b|| против Карацубы
+    for (size_t n : {size_t(1) << 10, size_t(1) << 14, size_t(1) << 17}) {
+        vector<double> a = densePolynomial(gen, n).getCoefficients();
+        vector<double> b = densePolynomial(gen, n).getCoefficients();
+        vector<double> exact = Polynomial::multiplyDense(a, b, Alg::KARATSUBA);
+        vector<double> approx = Polynomial::multiplyDense(a, b, Alg::FFT);
+        double normA = 0, normB = 0, err = 0;
+        for (size_t i = 0; i < n; ++i) {
+            normA += a[i] * a[i];
+            normB += b[i] * b[i];
+        }
+        for (size_t i = 0; i < exact.size(); ++i) err = max(err, fabs(exact[i] - approx[i]));
+        cout << "БПФ, длина " << n << ": max |ошибка| " << err << ", / (||a|| ||b||) = "
+             << err / sqrt(normA * normB) << endl;
+    }
+
+    // Степень 10^6: полный operator* и выборочная проверка коэффициентов в long double
+    {
+        size_t n = 1000001;
+        Polynomial p = densePolynomial(gen, n), q = densePolynomial(gen, n);
+        vector<double> a = p.getCoefficients(), b = q.getCoefficients();
+        Polynomial r;
+        double t = measureNs([&] { r = p * q; }, 1) / 1e6;
+        vector<double> rc = r.getCoefficients();
+        double err = 0;
+        uniform_int_distribution<size_t> index(0, 2 * n - 2);
+        for (int sample = 0; sample < 64; ++sample) {
+            size_t k = index(gen);
+            long double exact = 0;
+            for (size_t i = (k >= n ? k - n + 1 : 0); i <= min(k, n - 1); ++i) exact += (long double)a[i] * b[k - i];
+            err = max(err, double(fabsl(exact - rc[k])));
+        }
+        cout << "степень 10^6 x 10^6: " << t << " мс, max |ошибка| по 64 коэффициентам " << err << endl;
+    }
+
+    // Разреженные множители: почленно, без разворачивания в плотный массив
+    {
+        Polynomial p = randomPolynomial(gen, 200, 1000000), q = randomPolynomial(gen, 200, 1000000);
+        Polynomial r;
+        double t = measureNs([&] { r = p * q; }, 3) / 1000;
+        cout << "разреженные 200 x 200 членов до x^10^6: " << t << " мкс, членов " << r.termCount() << endl;
+    }
+    cout << endl;
+}
+
+void benchProcess() {
+    cout << "== process ==" << endl;
+    mt19937 gen(3);
+    const size_t n = 200000;
+    VectPolynomial v1, v2;
+    uniform_int_distribution<size_t> terms(4, 48);
+    for (size_t i = 0; i < n; ++i) {
+        v1.addPolynomial(randomPolynomial(gen, terms(gen), 64));
+        v2.addPolynomial(randomPolynomial(gen, terms(gen), 64));
+    }
+
+    // Исходная обработка: копии через getPolynomial и push_back
+    auto serialCopy = [&] {
+        vector<Polynomial> result;
+        for (size_t i = 0; i + 1 < n; i += 2) result.push_back(v1.getPolynomial(i) + v2.getPolynomial(i + 1));
+        for (size_t i = 1; i < n; i += 2) result.push_back(v1.getPolynomial(i) - v2.getPolynomial(i - 1));
+        return result;
+    };
+    vector<Polynomial> reference = serialCopy();
+    double base = measureNs(serialCopy, 3) / 1e6;
+    cout << n << " полиномов, исходный вариант: " << base << " мс" << endl;
+
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    vector<unsigned> counts;
+    for (unsigned threads = 1; threads < cores; threads *= 2) counts.push_back(threads);
+    counts.push_back(cores);
+    for (unsigned threads : counts) {
+        vector<Polynomial> result;
+        double t = measureNs([&] { result = VectPolynomial::processPolynomials(v1, v2, threads); }, 3) / 1e6;
+        bool same = result.size() == reference.size();
+        for (size_t i = 0; same && i < result.size(); ++i) {
+            same = result[i].getCoefficients() == reference[i].getCoefficients() &&
+                   result[i].getExponents() == reference[i].getExponents();
+        }
+        cout << "  потоков " << threads << ": " << t << " мс (x" << base / t << ")"
+             << (same ? "" : ", РЕЗУЛЬТАТ ОТЛИЧАЕТСЯ") << endl;
+    }
+    cout << endl;
+}
+
+// Число выделений памяти (если они считаются) и время одного вызова f
+template <typename F>
+void reportAllocations(const char* name, F f) {
+#ifdef POLYNOMIAL_COUNT_ALLOCATIONS
+    size_t before = allocationCount.load();
+#endif
+    auto start = chrono::steady_clock::now();
+    f();
+    auto stop = chrono::steady_clock::now();
+    cout << "  " << name << ": ";
+#ifdef POLYNOMIAL_COUNT_ALLOCATIONS
+    cout << allocationCount.load() - before << " выделений, ";
+#endif
+    cout << chrono::duration<double, milli>(stop - start).count() << " мс" << endl;
+}
+
+void benchAlloc() {
+    cout << "== alloc ==" << endl;
+#ifndef POLYNOMIAL_COUNT_ALLOCATIONS
+    cout << "(число выделений выводится в сборке с -DPOLYNOMIAL_COUNT_ALLOCATIONS)" << endl;
+#endif
+    mt19937 gen(4);
+    double sink = 0;
+
+    // Длинная цепочка сумм плотных полиномов
+    const size_t chain = 20000;
+    vector<Polynomial> terms;
+    for (size_t i = 0; i < chain; ++i) terms.push_back(densePolynomial(gen, 64 + i % 64));
+    cout << "сумма " << chain << " плотных полиномов:" << endl;
+    reportAllocations("sum = sum + p с копированием", [&] {
+        Polynomial sum;
+        for (const Polynomial& p : terms) {
+            const Polynomial& t = sum + p;
+            sum = t;
+        }
+        sink += sum.evaluate(0.5);
+    });
+    reportAllocations("sum = sum + p с перемещением", [&] {
+        Polynomial sum;
+        for (const Polynomial& p : terms) sum = sum + p;
+        sink += sum.evaluate(0.5);
+    });
+    reportAllocations("sum += p", [&] {
+        Polynomial sum;
+        for (const Polynomial& p : terms) sum += p;
+        sink += sum.evaluate(0.5);
+    });
+
+    // Выражение из нескольких операций: промежуточные результаты временные
+    cout << "a + b - c + d - e, " << chain / 5 << " раз:" << endl;
+    reportAllocations("по шагам с копированием", [&] {
+        for (size_t i = 0; i + 4 < chain; i += 5) {
+            Polynomial t(terms[i] + terms[i + 1]);
+            Polynomial u(t - terms[i + 2]);
+            Polynomial w(u + terms[i + 3]);
+            Polynomial r(w - terms[i + 4]);
+            sink += r.evaluate(0.5);
+        }
+    });
+    reportAllocations("одним выражением", [&] {
+        for (size_t i = 0; i + 4 < chain; i += 5) {
+            Polynomial r = terms[i] + terms[i + 1] - terms[i + 2] + terms[i + 3] - terms[i + 4];
+            sink += r.evaluate(0.5);
+        }
+    });
+
+    // Заполнение VectPolynomial
+    const size_t count = 100000;
+    cout << "заполнение VectPolynomial из " << count << " полиномов:" << endl;
+    reportAllocations("addPolynomial(const Polynomial&)", [&] {
+        VectPolynomial v;
+        for (size_t i = 0; i < count; ++i) {
+            vector<double> c(8, 1.0 + double(i));
+            vector<int> e{0, 3, 6, 9, 12, 15, 18, 21};
+            const Polynomial p(c, e);
+            v.addPolynomial(p);
+        }
+        sink += double(v.size());
+    });
+    reportAllocations("reserve + emplace(move(c), move(e))", [&] {
+        VectPolynomial v;
+        v.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            vector<double> c(8, 1.0 + double(i));
+            vector<int> e{0, 3, 6, 9, 12, 15, 18, 21};
+            v.emplace(move(c), move(e));
+        }
+        sink += double(v.size());
+    });
+
+    // Чтение коэффициентов
+    cout << "чтение коэффициентов " << chain << " полиномов:" << endl;
+    reportAllocations("getCoefficients()", [&] {
+        for (const Polynomial& p : terms) {
+            for (double c : p.getCoefficients()) sink += c;
+        }
+    });
+    reportAllocations("coefficientsView()", [&] {
+        for (const Polynomial& p : terms) {
+            for (double c : p.coefficientsView()) sink += c;
+        }
+    });
+    if (sink == 42) cout << "";
+    cout << endl;
+}
+
+void benchPool() {
+    cout << "== pool ==" << endl;
+    const size_t n = 1000000;
+    using Storage = VectPolynomial::Storage;
+
+    // Исходные полиномы: от 2 до 12 членов до x^16, часть плотные, часть разреженные
+    mt19937 gen(5);
+    uniform_int_distribution<size_t> terms(2, 12);
+    vector<Polynomial> source1, source2;
+    size_t terms1 = 0, terms2 = 0;
+    source1.reserve(n);
+    source2.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        source1.push_back(randomPolynomial(gen, terms(gen), 16));
+        source2.push_back(randomPolynomial(gen, terms(gen), 16));
+        terms1 += source1.back().coefficientsView().size();
+        terms2 += source2.back().coefficientsView().size();
+    }
+
+    for (Storage storage : {Storage::POOL, Storage::OBJECTS}) {
+        cout << (storage == Storage::POOL ? "PolynomialPool:" : "вектор Polynomial:") << endl;
+        auto v1 = make_unique<VectPolynomial>(storage), v2 = make_unique<VectPolynomial>(storage);
+        reportAllocations("заполнение 2 x 10^6", [&] {
+            v1->reserve(n, terms1);
+            v2->reserve(n, terms2);
+            for (size_t i = 0; i < n; ++i) {
+                v1->addPolynomial(source1[i]);
+                v2->addPolynomial(source2[i]);
+            }
+        });
+
+        double check = 0;
+        if (storage == Storage::POOL) {
+            unique_ptr<VectPolynomial> out;
+            reportAllocations("processPolynomialsPooled, 1 поток", [&] {
+                out = make_unique<VectPolynomial>(VectPolynomial::processPolynomialsPooled(*v1, *v2, 1));
+            });
+            for (size_t i = 0; i < out->size(); i += 1000) check += Polynomial(out->at(i)).evaluate(0.5);
+            reportAllocations("освобождение результата", [&] { out.reset(); });
+        } else {
+            unique_ptr<vector<Polynomial>> out;
+            reportAllocations("processPolynomials, 1 поток", [&] {
+                out = make_unique<vector<Polynomial>>(VectPolynomial::processPolynomials(*v1, *v2, 1));
+            });
+            for (size_t i = 0; i < out->size(); i += 1000) check += (*out)[i].evaluate(0.5);
+            reportAllocations("освобождение результата", [&] { out.reset(); });
+        }
+        reportAllocations("освобождение входов", [&] {
+            v1.reset();
+            v2.reset();
+        });
+        cout << "  контрольная сумма " << check << endl;
+    }
+    cout << endl;
+}
+
+void benchFile() {
+    cout << "== file ==" << endl;
+    const size_t n = 1000000;
+    mt19937 gen(6);
+    uniform_int_distribution<size_t> terms(2, 12);
+    VectPolynomial v1(VectPolynomial::Storage::POOL), v2(VectPolynomial::Storage::POOL);
+    for (size_t i = 0; i < n; ++i) {
+        v1.addPolynomial(randomPolynomial(gen, terms(gen), 16));
+        v2.addPolynomial(randomPolynomial(gen, terms(gen), 16));
+    }
+
+    // Однократные замеры без прогрева: важно именно первое обращение к файлу
+    auto timeMs = [](auto f) {
+        auto start = chrono::steady_clock::now();
+        f();
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    };
+
+    filesystem::path dir = filesystem::temp_directory_path();
+    string path1 = (dir / "polinomialno_v1.bin").string();
+    string path2 = (dir / "polinomialno_v2.bin").string();
+    string pathOut = (dir / "polinomialno_out.bin").string();
+
+    double t = timeMs([&] {
+        v1.save(path1);
+        v2.save(path2);
+    });
+    double megabytes = double(filesystem::file_size(path1) + filesystem::file_size(path2)) / (1 << 20);
+    cout << "запись 2 x " << n << " полиномов: " << t << " мс, " << megabytes << " МБ ("
+         << megabytes / t * 1000 << " МБ/с)" << endl;
+
+    VectPolynomial m1, m2;
+    t = timeMs([&] {
+        m1 = VectPolynomial::load(path1);
+        m2 = VectPolynomial::load(path2);
+    }) * 1000;
+    cout << "открытие (отображение): " << t << " мкс" << endl;
+
+    // Первый проход по отображенным данным - подгрузка страниц
+    double sink = 0;
+    t = timeMs([&] {
+        for (size_t i = 0; i < m1.size(); ++i) sink += m1.at(i).coefficients[0] + m2.at(i).coefficients[0];
+    });
+    cout << "первый проход по файлам: " << t << " мс" << endl;
+
+    t = timeMs([&] {
+        PolynomialFileWriter out(pathOut);
+        VectPolynomial::processPolynomials(m1, m2, out, 1);
+        out.close();
+    });
+    double memory = timeMs([&] { VectPolynomial::processPolynomialsPooled(v1, v2, 1); });
+    cout << "processPolynomials файл -> файл: " << t << " мс (в памяти, пул -> пул: " << memory << " мс)" << endl;
+
+    VectPolynomial expected = VectPolynomial::processPolynomialsPooled(v1, v2, 1);
+    VectPolynomial written = VectPolynomial::load(pathOut);
+    bool same = written.size() == expected.size();
+    for (size_t i = 0; same && i < written.size(); ++i) {
+        PolynomialView a = written.at(i), b = expected.at(i);
+        same = a.dense == b.dense && equal(a.coefficients.begin(), a.coefficients.end(), b.coefficients.begin(), b.coefficients.end()) &&
+               equal(a.exponents.begin(), a.exponents.end(), b.exponents.begin(), b.exponents.end());
+    }
+    cout << "результат в файле " << (same ? "совпадает" : "НЕ СОВПАДАЕТ") << " с расчетом в памяти" << endl;
+
+    m1.clear();
+    m2.clear();
+    written.clear();
+    filesystem::remove(path1);
+    filesystem::remove(path2);
+    filesystem::remove(pathOut);
+    if (sink == 42) cout << "";
+    cout << endl;
+}
+
+// Полином с заданными корнями: вещественные множители (x - r) и пары (x - z)(x - conj z)
+Polynomial polynomialFromRoots(const vector<complex<double>>& roots) {
+    Polynomial result({1.0}, {0});
+    for (const complex<double>& z : roots) {
+        if (z.imag() == 0.0) result *= Polynomial({-z.real(), 1.0}, {0, 1});
+        else if (z.imag() > 0.0) result *= Polynomial({norm(z), -2.0 * z.real(), 1.0}, {0, 1, 2});
+    }
+    return result;
+}
+
+void benchRoots() {
+    cout << "== roots ==" << endl;
+    mt19937 gen(7);
+    uniform_real_distribution<double> unit(-1.0, 1.0);
+
+    // Точность: известные корни вблизи единичной окружности (|z| = 1 +- 0.02, углы с
+    // разбросом вокруг равномерной сетки), для нечетной степени один корень вещественный.
+    // Обратная ошибка - max |p(z)| / sum |a_i| |z|^i по найденным корням (1e-16 - идеал),
+    // прямая ошибка к ней добавляет обусловленность корней. С ростом степени коэффициенты
+    // произведения множителей растут и сокращаются, поэтому уже при степени ~100 заданные
+    // корни - не корни вычисленного полинома; для больших степеней ниже только обратная
+    // ошибка на полиномах со случайными коэффициентами.
+    auto backwardError = [](const Polynomial& p, const vector<complex<double>>& roots) {
+        vector<double> a = p.getCoefficients();
+        double worst = 0;
+        for (const complex<double>& z : roots) {
+            complex<double> value = 0.0;
+            double scale = 0;
+            for (size_t i = a.size(); i-- > 0;) {
+                value = value * z + a[i];
+                scale = scale * abs(z) + fabs(a[i]);
+            }
+            worst = max(worst, abs(value) / scale);
+        }
+        return worst;
+    };
+    for (size_t degree : {11, 30, 50}) {
+        vector<complex<double>> expected;
+        size_t pairs = degree / 2;
+        for (size_t k = 0; k < pairs; ++k) {
+            double phi = acos(-1.0) * (double(k) + 0.5 + 0.3 * unit(gen)) / double(pairs);
+            expected.push_back(polar(1.0 + 0.02 * unit(gen), phi));
+            expected.push_back(conj(expected.back()));
+        }
+        if (degree % 2) expected.push_back(1.0 + 0.02 * unit(gen));
+        Polynomial p = polynomialFromRoots(expected);
+        vector<complex<double>> found;
+        double t = measureNs([&] { found = p.roots(); }, 3) / 1e3;
+        double err = 0;
+        for (const complex<double>& z : expected) {
+            double best = numeric_limits<double>::infinity();
+            for (const complex<double>& w : found) best = min(best, abs(z - w));
+            err = max(err, best);
+        }
+        cout << "степень " << degree << ": найдено " << found.size() << " корней, max ошибка " << err
+             << ", обратная ошибка " << backwardError(p, found) << ", " << t << " мкс" << endl;
+    }
+
+    for (size_t degree : {200, 1000}) {
+        Polynomial p = densePolynomial(gen, degree + 1);
+        vector<complex<double>> found;
+        double t = measureNs([&] { found = p.roots(); }, 1) / 1e3;
+        cout << "степень " << degree << ", случайные коэффициенты: найдено " << found.size()
+             << " корней, обратная ошибка " << backwardError(p, found) << ", " << t << " мкс" << endl;
+    }
+
+    // Вещественные корни: полином Чебышева T_20 (корни cos((2k - 1) pi / 40)) и кратный корень
+    {
+        Polynomial t0({1.0}, {0}), t1({1.0}, {1}), twoX({2.0}, {1});
+        for (int k = 1; k < 20; ++k) {
+            Polynomial t2 = twoX * t1 - t0;
+            t0 = move(t1);
+            t1 = move(t2);
+        }
+        vector<double> r = t1.realRoots(-1.0, 1.0);
+        double err = 0;
+        for (size_t k = 0; k < r.size(); ++k) {
+            err = max(err, fabs(r[k] - cos((2.0 * double(20 - k) - 1.0) * acos(-1.0) / 40.0)));
+        }
+        cout << "T_20 на [-1, 1]: " << r.size() << " корней, max ошибка " << err << endl;
+
+        Polynomial m = polynomialFromRoots({0.1, 0.3, 0.3, 0.3, 0.7});
+        cout << "(x - 0.1)(x - 0.3)^3(x - 0.7) на [0, 1]:";
+        for (double x : m.realRoots(0.0, 1.0)) cout << " " << x;
+        cout << endl;
+    }
+
+    // Производная первообразной возвращает исходный полином
+    {
+        Polynomial p = densePolynomial(gen, 100);
+        vector<double> a = p.getCoefficients(), b = p.antiderivative(1.0).derivative().getCoefficients();
+        double err = 0;
+        for (size_t i = 0; i < a.size(); ++i) err = max(err, fabs(a[i] - b[i]));
+        cout << "(первообразная)' - p: max ошибка " << err << endl;
+    }
+
+    // Пропускная способность пакетных версий
+    const size_t count = 20000;
+    VectPolynomial v(VectPolynomial::Storage::POOL);
+    for (size_t i = 0; i < count; ++i) v.addPolynomial(densePolynomial(gen, 9));
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    for (unsigned threads : {1u, cores}) {
+        double t = measureNs([&] { v.roots(threads); }, 1) / 1e9;
+        double tr = measureNs([&] { v.realRoots(-1.0, 1.0, threads); }, 1) / 1e9;
+        cout << count << " полиномов степени 8, потоков " << threads << ": roots " << count / t
+             << " полиномов/с, realRoots " << count / tr << " полиномов/с" << endl;
+        if (cores == 1) break;
+    }
+    cout << endl;
+}
+
+void runBenchmarks(const string& only) {
+    if (only.empty() || only == "evaluate") benchEvaluate();
+    if (only.empty() || only == "multiply") benchMultiply();
+    if (only.empty() || only == "process") benchProcess();
+    if (only.empty() || only == "alloc") benchAlloc();
+    if (only.empty() || only == "pool") benchPool();
+    if (only.empty() || only == "file") benchFile();
+    if (only.empty() || only == "roots") benchRoots();
+}
+
+int main(int argc, char* argv[]) {
     setlocale(LC_ALL, "rus");
 
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        runBenchmarks(argc > 2 ? argv[2] : "");
+        return 0;
+    }
+
+    // Обработка векторов из двоичных файлов: polinomialno --process v1.bin v2.bin out.bin
+    if (argc > 1 && string(argv[1]) == "--process") {
+        if (argc != 5) {
+            cerr << "Использование: " << argv[0] << " --process v1.bin v2.bin out.bin" << endl;
+            return 1;
+        }
+        try {
+            VectPolynomial f1 = VectPolynomial::load(argv[2]);
+            VectPolynomial f2 = VectPolynomial::load(argv[3]);
+            PolynomialFileWriter out(argv[4]);
+            VectPolynomial::processPolynomials(f1, f2, out);
+            out.close();
+            cout << "Записано полиномов: " << out.size() << endl;
+        } catch (const exception& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        return 0;
+    }
+
     VectPolynomial v1, v2;
     int n;
 
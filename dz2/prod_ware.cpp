@@ -7,6 +7,32 @@
 #include <ctime>
 #include <iomanip>
 #include <limits>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#include <array>
+#include <queue>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <numeric>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
 
 using namespace std;
 
@@ -36,6 +62,10 @@ public:
         generateBarcode();
     }
 
+    // С готовым штрих-кодом: общий rand() не трогается (для рабочих потоков)
+    Product(string bc, string desc, float p, int q, float tLong, float tLat)
+        : barcode(move(bc)), description(move(desc)), price(p), quantity(q), transportLongitude(tLong), transportLatitude(tLat) {}
+
     // Конструктор копирования
     Product(const Product& other) {
         barcode = other.barcode;
@@ -46,16 +76,33 @@ public:
         transportLatitude = other.transportLatitude;
     }
 
+    // Перемещение (строки не копируются при росте вектора и удалении из склада)
+    Product(Product&& other) noexcept = default;
+    Product& operator=(const Product& other) = default;
+    Product& operator=(Product&& other) noexcept = default;
+
     // Генерация штрих-кода
     void generateBarcode() {
-        barcode = "460"; 
+        barcode = makeBarcode([] { return rand(); });
+    }
+
+    // То же на генераторе потока (rand() общий для всех потоков)
+    void generateBarcode(mt19937& gen) {
+        barcode = makeBarcode([&] { return int(gen() >> 1); });
+    }
+
+    // Штрих-код "460" + код группы + 6 цифр; next() - неотрицательное случайное число
+    template <typename Next>
+    static string makeBarcode(Next next) {
+        string result = "460"; 
 
-        int part = (rand() % 9 + 1) * 1000;
-        barcode += to_string(part);
+        int part = (next() % 9 + 1) * 1000;
+        result += to_string(part);
 
         for (int i = 0; i < 6; ++i) {
-            barcode += to_string(rand() % 10);
+            result += to_string(next() % 10);
         }
+        return result;
     }
 
     // Setters
@@ -85,11 +132,11 @@ public:
     }
 
     // Getters
-    string getBarcode() const 
+    const string& getBarcode() const 
     {
         return barcode; 
     }
-    string getDescription() const 
+    const string& getDescription() const 
     {
         return description; 
     }
@@ -120,303 +167,4476 @@ public:
     }
 };
 
-// Класс Warehouse
-class Warehouse {
+// Пул описаний: каждая различная строка хранится один раз в блоках по 64 КБ
+// (блоки не перемещаются, поэтому string_view на них стабильны), продукт
+// ссылается на нее номером. Строки из пула не удаляются - вместо этого
+// ProductColumns::compact собирает новый пул из используемых строк
+class DescriptionPool {
 private:
-    string id; // идентификатор
-    WarehouseType type; // тип
-    float longitude; // долгота
-    float latitude; // широта
-    int maxCapacity; // максимальная вместимость
-    int totalStock; // общий запас
-    vector<Product> products; // список продуктов
-    static int warehouseCounter; 
+    static constexpr size_t blockSize = 1 << 16;
+
+    vector<unique_ptr<char[]>> blocks;
+    char* current = nullptr; // блок, в который дописываются строки
+    size_t used = blockSize; // занято в нем
+    size_t bytes = 0; // выделено блоков, байт
+    vector<string_view> texts; // номер -> строка
+    unordered_map<string_view, uint32_t> ids; // строка -> номер
 
 public:
-    // Конструкторы
-    Warehouse() : id(""), type(WarehouseType::CENTER), longitude(0.0), latitude(0.0), maxCapacity(0), totalStock(0) {}
+    DescriptionPool() = default;
 
-    Warehouse(WarehouseType t, float lon, float lat, int maxCap)
-        : type(t), longitude(lon), latitude(lat), maxCapacity(maxCap), totalStock(0) {
-        generateId();
+    DescriptionPool(const DescriptionPool& other) {
+        for (string_view text : other.texts) intern(text);
     }
 
-    // Конструктор копирования
-    Warehouse(const Warehouse& other) {
-        id = other.id;
-        type = other.type;
-        longitude = other.longitude;
-        latitude = other.latitude;
-        maxCapacity = other.maxCapacity;
-        totalStock = other.totalStock;
-        products = other.products;
+    DescriptionPool& operator=(const DescriptionPool& other) {
+        if (this != &other) {
+            DescriptionPool copy(other);
+            swap(copy);
+        }
+        return *this;
     }
 
-    // Деструктор
-    ~Warehouse() {
-        products.clear();
+    void swap(DescriptionPool& other) {
+        blocks.swap(other.blocks);
+        std::swap(current, other.current);
+        std::swap(used, other.used);
+        std::swap(bytes, other.bytes);
+        texts.swap(other.texts);
+        ids.swap(other.ids);
     }
 
-    // Генерация ID склада
-    void generateId() {
-        int code = 100 + warehouseCounter++;
-        id = "W" + to_string(code);
+    // Номер строки text (добавляется, если ее еще нет)
+    uint32_t intern(string_view text) {
+        auto it = ids.find(text);
+        if (it != ids.end()) return it->second;
+        char* place = nullptr;
+        if (text.size() > blockSize / 4) {
+            // Длинная строка - отдельным блоком, текущий остается открытым
+            blocks.emplace_back(new char[text.size()]);
+            place = blocks.back().get();
+            bytes += text.size();
+        }
+        else if (!text.empty()) {
+            if (used + text.size() > blockSize) {
+                blocks.emplace_back(new char[blockSize]);
+                current = blocks.back().get();
+                bytes += blockSize;
+                used = 0;
+            }
+            place = current + used;
+            used += text.size();
+        }
+        if (place) memcpy(place, text.data(), text.size());
+        string_view stored(place, text.size());
+        uint32_t id = uint32_t(texts.size());
+        texts.push_back(stored);
+        ids.emplace(stored, id);
+        return id;
     }
 
-    // Добавление продукта
-    bool addProduct(const Product& product) {
-        if (totalStock + product.getQuantity() <= maxCapacity) {
-            products.push_back(product);
-            totalStock += product.getQuantity();
-            return true;
-        }
-        return false;
+    string_view operator[](uint32_t id) const {
+        return texts[id];
     }
 
-    // Удаление продукта по штрих-коду
-    bool removeProduct(string barcode) {
-        for (auto it = products.begin(); it != products.end(); ++it) {
-            if (it->getBarcode() == barcode) {
-                totalStock -= it->getQuantity();
-                products.erase(it);
-                return true;
-            }
+    size_t size() const {
+        return texts.size();
+    }
+
+    // Занятая память (блоки, номера и хеш-таблица), байт
+    size_t memoryBytes() const {
+        return bytes + texts.capacity() * sizeof(string_view) +
+            ids.size() * (sizeof(string_view) + sizeof(uint32_t) + 2 * sizeof(void*)) + ids.bucket_count() * sizeof(void*);
+    }
+};
+
+// Колоночное хранение продуктов: каждое поле - отдельный плотный массив, штрих-код -
+// 64-битное число, описание - номер в пуле. Около 36 байт на продукт вместо объекта
+// Product с двумя строками, проходы по цене или количеству читают только свой массив.
+// Штрих-код кодируется как (число цифр << 59) | значение: так сохраняются ведущие
+// нули, а длина до 17 цифр покрывает EAN-13 из generateBarcode с запасом.
+// Удаление - перенос последнего продукта на место удаленного, как в Warehouse.
+// Продукты с одним описанием связаны двусвязным списком по номерам (firstSlot,
+// nextSlot, prevSlot): поиск по описанию обходит только их, а не всю колонку
+class ProductColumns {
+private:
+    vector<uint64_t> barcodes;
+    vector<uint32_t> descriptions;
+    vector<float> prices;
+    vector<int32_t> quantities;
+    vector<float> longitudes;
+    vector<float> latitudes;
+    vector<uint32_t> nextSlot; // следующий продукт с тем же описанием или noSlot
+    vector<uint32_t> prevSlot; // предыдущий продукт с тем же описанием или noSlot
+    vector<uint32_t> firstSlot; // описание -> первый продукт с ним или noSlot
+    vector<uint32_t> useCount; // описание -> число продуктов с ним
+    size_t usedDescriptions = 0; // описаний с ненулевым useCount
+    DescriptionPool pool;
+
+    // Продукт slot (с уже записанным описанием) в начало списка своего описания
+    void link(size_t slot) {
+        uint32_t text = descriptions[slot];
+        if (text >= firstSlot.size()) {
+            firstSlot.resize(pool.size(), noSlot);
+            useCount.resize(pool.size(), 0);
         }
-        return false;
+        prevSlot[slot] = noSlot;
+        nextSlot[slot] = firstSlot[text];
+        if (firstSlot[text] != noSlot) prevSlot[firstSlot[text]] = uint32_t(slot);
+        firstSlot[text] = uint32_t(slot);
+        if (useCount[text]++ == 0) ++usedDescriptions;
     }
 
-    // Поиск продукта по описанию
-    vector<Product> findProduct(string desc) const {
-        vector<Product> result;
-        for (const auto& product : products) {
-            if (product.getDescription().find(desc) != string::npos) {
-                result.push_back(product);
-            }
+    // Продукт slot из списка своего описания
+    void unlink(size_t slot) {
+        uint32_t text = descriptions[slot];
+        if (prevSlot[slot] != noSlot) nextSlot[prevSlot[slot]] = nextSlot[slot];
+        else firstSlot[text] = nextSlot[slot];
+        if (nextSlot[slot] != noSlot) prevSlot[nextSlot[slot]] = prevSlot[slot];
+        if (--useCount[text] == 0) --usedDescriptions;
+    }
+
+public:
+    static constexpr size_t maxBarcodeDigits = 17;
+    static constexpr uint32_t noSlot = UINT32_MAX;
+
+    // Штрих-код из цифр (не длиннее maxBarcodeDigits) в число; false, если не кодируется
+    static bool encodeBarcode(const string& barcode, uint64_t& code) {
+        if (barcode.size() > maxBarcodeDigits) return false;
+        uint64_t value = 0;
+        for (char c : barcode) {
+            if (c < '0' || c > '9') return false;
+            value = value * 10 + uint64_t(c - '0');
         }
-        return result;
+        code = uint64_t(barcode.size()) << 59 | value;
+        return true;
     }
 
-    // Вычисление расстояния Манхэттена
-    float calculateDistance(float productLong, float productLat) const {
-        return abs(latitude - productLat) + abs(longitude - productLong);
+    static string decodeBarcode(uint64_t code) {
+        size_t digits = size_t(code >> 59);
+        uint64_t value = code & ((uint64_t(1) << 59) - 1);
+        string barcode(digits, '0');
+        for (size_t i = digits; i-- > 0; value /= 10) barcode[i] = char('0' + value % 10);
+        return barcode;
     }
 
-    // Обновление общего запаса
-    void updateStock(int delta) {
-        totalStock += delta;
+    // Можно ли хранить продукт в колонках (штрих-код кодируется числом)
+    static bool fits(const Product& product) {
+        uint64_t code;
+        return encodeBarcode(product.getBarcode(), code);
     }
 
-    // Печать информации о складе
-    void print() const {
-        cout << "ID склада: " << id << endl;
-        cout << "Тип: ";
-        switch (type) {
-        case WarehouseType::CENTER:
-            cout << "центр";
-            break;
-        case WarehouseType::WEST:
-            cout << "запад";
-            break;
-        case WarehouseType::EAST:
-            cout << "восток";
-            break;
+    size_t size() const {
+        return barcodes.size();
+    }
+
+    void reserve(size_t n) {
+        barcodes.reserve(n);
+        descriptions.reserve(n);
+        prices.reserve(n);
+        quantities.reserve(n);
+        longitudes.reserve(n);
+        latitudes.reserve(n);
+        nextSlot.reserve(n);
+        prevSlot.reserve(n);
+    }
+
+    // Добавление в конец; штрих-код должен кодироваться (fits)
+    void push_back(const Product& product) {
+        uint64_t code = 0;
+        encodeBarcode(product.getBarcode(), code);
+        barcodes.push_back(code);
+        descriptions.push_back(pool.intern(product.getDescription()));
+        prices.push_back(product.getPrice());
+        quantities.push_back(product.getQuantity());
+        longitudes.push_back(product.getTransportLong());
+        latitudes.push_back(product.getTransportLat());
+        nextSlot.push_back(noSlot);
+        prevSlot.push_back(noSlot);
+        link(barcodes.size() - 1);
+    }
+
+    // Замена продукта slot; штрих-код должен кодироваться (fits)
+    void set(size_t slot, const Product& product) {
+        encodeBarcode(product.getBarcode(), barcodes[slot]);
+        uint32_t text = pool.intern(product.getDescription());
+        if (text != descriptions[slot]) {
+            unlink(slot);
+            descriptions[slot] = text;
+            link(slot);
         }
-        cout << endl;
-        cout << "Координаты: (" << longitude << ", " << latitude << ")" << endl;
-        cout << "Макс. вместимость: " << maxCapacity << endl;
-        cout << "Текущий запас: " << totalStock << endl;
-        cout << "Количество продуктов: " << products.size() << endl;
+        prices[slot] = product.getPrice();
+        quantities[slot] = product.getQuantity();
+        longitudes[slot] = product.getTransportLong();
+        latitudes[slot] = product.getTransportLat();
     }
 
-    // Список продуктов
-    void listProducts() const {
-        if (products.empty()) {
-            cout << "Склад пуст." << endl;
-            return;
+    // Удаление продукта slot: на его место переносится последний
+    void removeAt(size_t slot) {
+        size_t last = size() - 1;
+        unlink(slot);
+        if (slot != last) {
+            // Соседи last по списку описания теперь ссылаются на slot
+            uint32_t prev = prevSlot[last], next = nextSlot[last];
+            if (prev != noSlot) nextSlot[prev] = uint32_t(slot);
+            else firstSlot[descriptions[last]] = uint32_t(slot);
+            if (next != noSlot) prevSlot[next] = uint32_t(slot);
+            prevSlot[slot] = prev;
+            nextSlot[slot] = next;
         }
-        for (const auto& product : products) {
-            product.print();
-            cout << "-------------------" << endl;
+        barcodes[slot] = barcodes[last];
+        descriptions[slot] = descriptions[last];
+        prices[slot] = prices[last];
+        quantities[slot] = quantities[last];
+        longitudes[slot] = longitudes[last];
+        latitudes[slot] = latitudes[last];
+        barcodes.pop_back();
+        descriptions.pop_back();
+        prices.pop_back();
+        quantities.pop_back();
+        longitudes.pop_back();
+        latitudes.pop_back();
+        nextSlot.pop_back();
+        prevSlot.pop_back();
+    }
+
+    void clear() {
+        barcodes.clear();
+        descriptions.clear();
+        prices.clear();
+        quantities.clear();
+        longitudes.clear();
+        latitudes.clear();
+        nextSlot.clear();
+        prevSlot.clear();
+        firstSlot.assign(firstSlot.size(), noSlot);
+        useCount.assign(useCount.size(), 0);
+        usedDescriptions = 0;
+    }
+
+    // Новый пул только из используемых описаний, если неиспользуемых (после удалений
+    // и замен) больше 1024 и больше используемых; порядок описаний сохраняется.
+    // true - номера описаний поменялись, индекс по пулу нужно перестроить
+    bool compact() {
+        size_t unused = pool.size() - usedDescriptions;
+        if (unused <= 1024 || unused <= usedDescriptions) return false;
+        DescriptionPool fresh;
+        vector<uint32_t> renumber(pool.size(), noSlot);
+        vector<uint32_t> first, count;
+        first.reserve(usedDescriptions);
+        count.reserve(usedDescriptions);
+        for (uint32_t text = 0; text < pool.size(); ++text) {
+            if (text >= useCount.size() || useCount[text] == 0) continue;
+            renumber[text] = fresh.intern(pool[text]);
+            first.push_back(firstSlot[text]);
+            count.push_back(useCount[text]);
         }
+        for (uint32_t& text : descriptions) text = renumber[text];
+        pool.swap(fresh);
+        firstSlot.swap(first);
+        useCount.swap(count);
+        return true;
     }
 
-    // Getters
-    string getId() const 
-    {
-        return id; 
+    // Обход продуктов с описанием text: от firstWith до noSlot через nextWith
+    uint32_t firstWith(uint32_t text) const {
+        return text < firstSlot.size() ? firstSlot[text] : noSlot;
     }
-    WarehouseType getType() const 
-    {
-        return type; 
+    uint32_t nextWith(size_t slot) const {
+        return nextSlot[slot];
     }
-    pair<float, float> getCoordinates() const 
-    {
-        return { longitude, latitude }; 
+
+    // Сборка объекта Product из колонок (без генерации штрих-кода и rand())
+    Product product(size_t slot) const {
+        return Product(decodeBarcode(barcodes[slot]), string(pool[descriptions[slot]]), prices[slot], quantities[slot],
+            longitudes[slot], latitudes[slot]);
     }
-    int getMaxCapacity() const 
-    {
-        return maxCapacity; 
+
+    // Колонки целиком для проходов
+    const vector<uint64_t>& barcodeColumn() const {
+        return barcodes;
     }
-    int getTotalStock() const 
-    {
-        return totalStock; 
+    const vector<uint32_t>& descriptionColumn() const {
+        return descriptions;
     }
-    vector<Product> getProducts() const 
-    {
-        return products; 
+    const vector<float>& priceColumn() const {
+        return prices;
+    }
+    const vector<int32_t>& quantityColumn() const {
+        return quantities;
+    }
+    const vector<float>& longitudeColumn() const {
+        return longitudes;
+    }
+    const vector<float>& latitudeColumn() const {
+        return latitudes;
+    }
+    const DescriptionPool& descriptionPool() const {
+        return pool;
+    }
+
+    // Занятая память, байт
+    size_t memoryBytes() const {
+        return barcodes.capacity() * sizeof(uint64_t) + descriptions.capacity() * sizeof(uint32_t) +
+            (prices.capacity() + longitudes.capacity() + latitudes.capacity()) * sizeof(float) +
+            quantities.capacity() * sizeof(int32_t) +
+            (nextSlot.capacity() + prevSlot.capacity() + firstSlot.capacity() + useCount.capacity()) * sizeof(uint32_t) +
+            pool.memoryBytes();
     }
 };
 
-int Warehouse::warehouseCounter = 0;
+// Доступ индексов к ключам продукта при обоих способах хранения
+inline const string& barcodeKey(const vector<Product>& products, size_t slot) {
+    return products[slot].getBarcode();
+}
 
-// Функция для создания продукта
-Product createProduct() {
-    string desc;
-    float price;
-    int quantity;
-    float tLong, tLat;
+inline uint64_t barcodeKey(const ProductColumns& columns, size_t slot) {
+    return columns.barcodeColumn()[slot];
+}
 
-    cout << "Введите описание продукта (до 50 символов): ";
-    cin.ignore();
-    getline(cin, desc);
-    if (desc.length() > 50) desc = desc.substr(0, 50);
+inline string_view descriptionText(const vector<Product>& products, size_t slot) {
+    return products[slot].getDescription();
+}
 
-    cout << "Введите цену продукта: ";
-    cin >> price;
+inline string_view descriptionText(const DescriptionPool& pool, size_t slot) {
+    return pool[uint32_t(slot)];
+}
 
-    cout << "Введите количество: ";
-    cin >> quantity;
+// Индекс штрих-кодов склада: открытая адресация с линейным пробированием.
+// В корзине - хеш штрих-кода и номер продукта на складе, сами ключи хранятся
+// только в продуктах (строкой в Product или числом в ProductColumns, см. barcodeKey).
+// Одинаковые штрих-коды допустимы (generateBarcode может повториться): каждый
+// занимает свою корзину, поиск возвращает наименьший номер продукта среди них.
+// Порядок корзин в цепочке меняют удаления и перестроения, а номера продуктов
+// зависят только от последовательности операций - так журнал, воспроизведенный
+// после загрузки снимка, удаляет и изменяет те же продукты, что и живой склад.
+// Удаление сдвигает следующие корзины цепочки назад, без надгробий, поэтому поиск
+// не деградирует при постоянном обороте товаров. Заполнение не больше половины.
+class BarcodeIndex {
+private:
+    struct Bucket {
+        uint32_t hash;
+        uint32_t slot; // номер продукта или emptySlot
+    };
 
-    cout << "Введите долготу транспортировки (19-169): ";
-    cin >> tLong;
-    tLong = max(19.0f, min(169.0f, tLong));
+    static constexpr uint32_t emptySlot = UINT32_MAX;
 
-    cout << "Введите широту транспортировки (41-82): ";
-    cin >> tLat;
-    tLat = max(41.0f, min(82.0f, tLat));
+    vector<Bucket> buckets;
+    size_t count = 0;
 
-    return Product(desc, price, quantity, tLong, tLat);
-}
+    size_t mask() const {
+        return buckets.size() - 1;
+    }
 
-// Главное меню
-void menu() {
-    vector<Warehouse> warehouses = {
-        Warehouse(WarehouseType::CENTER, 55.75, 37.62, 1000),  
-        Warehouse(WarehouseType::WEST, 59.94, 30.31, 800),     
-        Warehouse(WarehouseType::EAST, 56.83, 60.60, 1200)      
-    };
+    // Корзина, в которой записан продукт slot
+    template <typename Products>
+    size_t bucketOf(const Products& products, size_t slot) const {
+        uint32_t h = hashOf(barcodeKey(products, slot));
+        size_t i = h & mask();
+        while (buckets[i].slot != slot) i = (i + 1) & mask();
+        return i;
+    }
 
-    while (true) {
-        cout << "\n=== Меню управления складами ===" << endl;
-        cout << "1. Добавить продукт на склад" << endl;
-        cout << "2. Просмотреть продукты на складе" << endl;
-        cout << "3. Поиск продукта по описанию" << endl;
-        cout << "4. Удалить продукт" << endl;
-        cout << "5. Информация о складах" << endl;
-        cout << "0. Выход" << endl;
-        cout << endl << "Выберите действие: ";
+    void place(uint32_t h, uint32_t slot) {
+        size_t i = h & mask();
+        while (buckets[i].slot != emptySlot) i = (i + 1) & mask();
+        buckets[i] = Bucket{h, slot};
+        ++count;
+    }
 
-        int choice;
-        cin >> choice;
+public:
+    static constexpr size_t notFound = SIZE_MAX;
 
-        cout << endl;
+    // FNV-1a с перемешиванием старших битов в младшие (по младшим выбирается корзина)
+    static uint32_t hashOf(const string& key) {
+        uint64_t h = 14695981039346656037ull;
+        for (unsigned char c : key) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        h ^= h >> 29;
+        h *= 0xbf58476d1ce4e5b9ull;
+        return uint32_t(h ^ (h >> 32));
+    }
 
-        if (choice == 0) break;
+    // Для штрих-кодов, закодированных числом (ProductColumns)
+    static uint32_t hashOf(uint64_t key) {
+        key ^= key >> 31;
+        key *= 0x9e3779b97f4a7c15ull;
+        key ^= key >> 29;
+        return uint32_t(key ^ (key >> 32));
+    }
 
-        switch (choice) {
-        case 1: {
-            Product p = createProduct();
+    // Переиндексация всех продуктов в таблицу не меньше чем на 2 * max(products.size(), expected) корзин
+    template <typename Products>
+    void rebuild(const Products& products, size_t expected = 0) {
+        size_t capacity = 16;
+        while (capacity < 2 * max(products.size(), expected)) capacity *= 2;
+        buckets.assign(capacity, Bucket{0, emptySlot});
+        count = 0;
+        for (size_t slot = 0; slot < products.size(); ++slot) place(hashOf(barcodeKey(products, slot)), uint32_t(slot));
+    }
 
-            float tLong = p.getTransportLong();
-            float tLat = p.getTransportLat();
+    // Место под expected продуктов без перестроений при добавлении
+    template <typename Products>
+    void reserve(const Products& products, size_t expected) {
+        if (2 * expected > buckets.size()) rebuild(products, expected);
+    }
 
-            // Находим склад с минимальным расстоянием
-            int bestWarehouse = 0;
-            float minDist = warehouses[0].calculateDistance(tLong, tLat);
+    // Добавление продукта slot (уже лежащего в products)
+    template <typename Products>
+    void insert(const Products& products, size_t slot) {
+        if (2 * (count + 1) > buckets.size()) {
+            rebuild(products);
+            return;
+        }
+        place(hashOf(barcodeKey(products, slot)), uint32_t(slot));
+    }
 
-            for (int i = 1; i < warehouses.size(); ++i) {
-                float dist = warehouses[i].calculateDistance(tLong, tLat);
-                if (dist < minDist) {
-                    minDist = dist;
-                    bestWarehouse = i;
-                }
+    // Наименьший номер продукта со штрих-кодом barcode или notFound (цепочка
+    // просматривается до пустой корзины: дубликаты могут стоять в ней в любом порядке)
+    template <typename Products, typename Key>
+    size_t find(const Products& products, const Key& barcode) const {
+        size_t found = notFound;
+        if (buckets.empty()) return found;
+        uint32_t h = hashOf(barcode);
+        for (size_t i = h & mask(); buckets[i].slot != emptySlot; i = (i + 1) & mask()) {
+            if (buckets[i].slot < found && buckets[i].hash == h && barcodeKey(products, buckets[i].slot) == barcode) {
+                found = buckets[i].slot;
             }
+        }
+        return found;
+    }
 
-            if (warehouses[bestWarehouse].addProduct(p)) {
-                cout << "Продукт добавлен на склад " << warehouses[bestWarehouse].getId() << endl;
-            }
-            else {
-                cout << "Склад переполнен!" << endl;
+    // Удаление записи продукта slot: следующие корзины цепочки, которые могут
+    // стоять раньше (их домашняя корзина не в (i, j]), сдвигаются на освободившееся место
+    template <typename Products>
+    void erase(const Products& products, size_t slot) {
+        size_t i = bucketOf(products, slot);
+        for (size_t j = (i + 1) & mask(); buckets[j].slot != emptySlot; j = (j + 1) & mask()) {
+            size_t home = buckets[j].hash & mask();
+            bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+            if (!stays) {
+                buckets[i] = buckets[j];
+                i = j;
             }
-            break;
         }
-        case 2: {
-            cout << "Выберите склад (1-Центр, 2-Запад, 3-Восток): ";
-            int wh;
-            cin >> wh;
-            if (wh >= 1 && wh <= 3) {
-                warehouses[wh - 1].listProducts();
-            }
-            else {
-                cout << "Неверный выбор!" << endl;
-            }
-            break;
+        buckets[i].slot = emptySlot;
+        --count;
+    }
+
+    // Продукт переехал из from в to (перенос последнего на место удаленного)
+    template <typename Products>
+    void relocate(const Products& products, size_t from, size_t to) {
+        buckets[bucketOf(products, from)].slot = uint32_t(to);
+    }
+
+    void clear() {
+        buckets.clear();
+        count = 0;
+    }
+
+    // Занятая память, байт
+    size_t memoryBytes() const {
+        return buckets.capacity() * sizeof(Bucket);
+    }
+};
+
+// Индекс описаний для поиска по подстроке: инвертированный индекс триграмм
+// (три подряд идущих байта, так что кириллица в UTF-8 тоже работает).
+// Каждой записи продукта дается номер по возрастанию, списки номеров по
+// триграмме поэтому всегда отсортированы и пересекаются бинарным поиском.
+// Списки лежат подряд в одном массиве (основа) по триграммам в порядке
+// возрастания; новые записи копятся в хеш-таблице и вливаются в основу, когда
+// их становится больше, чем в основе (пакеты - сразу). Номера в таблице больше
+// номеров основы, так что список триграммы - часть основы и продолжение из таблицы.
+// Удаление ленивое: номер помечается мертвым, из списков он уходит при
+// переиндексации, когда мертвых записей становится больше живых.
+// Кандидаты после пересечения проверяются настоящим find - триграммы
+// необходимое, но не достаточное условие вхождения.
+class DescriptionIndex {
+private:
+    static constexpr uint32_t deadSlot = UINT32_MAX;
+
+    vector<uint32_t> baseKeys; // триграммы основы по возрастанию
+    vector<uint32_t> baseStart; // начало списка baseKeys[i] в baseIds, в конце - размер
+    vector<uint32_t> baseIds;
+    unordered_map<uint32_t, vector<uint32_t>> recent; // триграмма -> номера после слияния
+    size_t recentCount = 0;
+    vector<uint32_t> slotOf; // номер записи -> номер продукта или deadSlot
+    vector<uint32_t> idOf; // номер продукта -> номер записи
+    size_t dead = 0;
+
+    // Список номеров триграммы: часть из основы и продолжение из recent
+    struct Postings {
+        const uint32_t* head = nullptr;
+        size_t headSize = 0;
+        const uint32_t* tail = nullptr;
+        size_t tailSize = 0;
+
+        size_t size() const {
+            return headSize + tailSize;
         }
-        case 3: {
-            string desc;
-            cout << "Введите часть описания для поиска: ";
-            cin.ignore();
-            getline(cin, desc);
 
-            for (int i = 0; i < warehouses.size(); ++i) {
-                vector<Product> found = warehouses[i].findProduct(desc);
-                if (!found.empty()) {
-                    cout << "\nНайдено на складе " << warehouses[i].getId() << ":" << endl;
-                    for (const auto& p : found) {
-                        p.print();
-                        cout << "-------------------" << endl;
-                    }
-                }
-            }
-            break;
+        uint32_t operator[](size_t i) const {
+            return i < headSize ? head[i] : tail[i - headSize];
         }
-        case 4: {
-            cout << "Выберите склад (1-Центр, 2-Запад, 3-Восток): ";
-            int wh;
-            cin >> wh;
-            if (wh < 1 || wh > 3) {
-                cout << "Неверный выбор!" << endl;
-                break;
-            }
+    };
 
-            string barcode;
-            cout << "Введите штрих-код продукта для удаления: ";
-            cin >> barcode;
+    static uint32_t trigram(string_view s, size_t i) {
+        return uint32_t((unsigned char)s[i]) << 16 | uint32_t((unsigned char)s[i + 1]) << 8 | (unsigned char)s[i + 2];
+    }
 
-            if (warehouses[wh - 1].removeProduct(barcode)) {
-                cout << "Продукт удален." << endl;
-            }
-            else {
-                cout << "Продукт не найден!" << endl;
-            }
-            break;
+    // Первая позиция не раньше from, где list[i] >= id: шаги удваиваются, затем бинарный поиск
+    static size_t gallop(const Postings& list, size_t from, uint32_t id) {
+        size_t hi = from;
+        for (size_t step = 1; hi < list.size() && list[hi] < id; step *= 2) {
+            from = hi + 1;
+            hi += step;
         }
-        case 5: {
-            for (const auto& wh : warehouses) {
-                wh.print();
-                cout << "===================" << endl;
-            }
-            break;
+        for (hi = min(hi, list.size()); from < hi;) {
+            size_t mid = from + (hi - from) / 2;
+            if (list[mid] < id) from = mid + 1;
+            else hi = mid;
         }
-        default:
-            cout << "Неверный выбор!" << endl;
+        return from;
+    }
+
+    // Различные триграммы строки
+    static vector<uint32_t> trigramsOf(string_view s) {
+        vector<uint32_t> result;
+        if (s.size() < 3) return result;
+        result.reserve(s.size() - 2);
+        for (size_t i = 0; i + 2 < s.size(); ++i) result.push_back(trigram(s, i));
+        sort(result.begin(), result.end());
+        result.erase(unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    Postings postingsOf(uint32_t t) const {
+        Postings list;
+        auto key = lower_bound(baseKeys.begin(), baseKeys.end(), t);
+        if (key != baseKeys.end() && *key == t) {
+            size_t i = key - baseKeys.begin();
+            list.head = baseIds.data() + baseStart[i];
+            list.headSize = baseStart[i + 1] - baseStart[i];
+        }
+        auto it = recent.find(t);
+        if (it != recent.end()) {
+            list.tail = it->second.data();
+            list.tailSize = it->second.size();
+        }
+        return list;
+    }
+
+    // Сортировка пар (триграмма, номер), выписанных по возрастанию номера: по 24-битной
+    // триграмме поразрядно в два прохода по 12 бит, порядок номеров сохраняется
+    static void sortPairs(vector<pair<uint32_t, uint32_t>>& pairs) {
+        vector<pair<uint32_t, uint32_t>> buffer(pairs.size());
+        for (int shift : {0, 12}) {
+            vector<uint32_t> start(4097, 0);
+            for (const auto& p : pairs) ++start[((p.first >> shift) & 4095) + 1];
+            for (size_t i = 1; i < start.size(); ++i) start[i] += start[i - 1];
+            for (const auto& p : pairs) buffer[start[(p.first >> shift) & 4095]++] = p;
+            pairs.swap(buffer);
+        }
+    }
+
+    // Слияние основы, recent и отсортированных пар (триграмма, номер) в новую основу.
+    // Номера recent больше номеров основы, номера пар - больше всех имеющихся
+    void merge(const vector<pair<uint32_t, uint32_t>>& pairs) {
+        vector<uint32_t> recentKeys;
+        recentKeys.reserve(recent.size());
+        for (const auto& list : recent) recentKeys.push_back(list.first);
+        sort(recentKeys.begin(), recentKeys.end());
+
+        vector<uint32_t> keys, start, ids;
+        keys.reserve(baseKeys.size() + recentKeys.size());
+        start.reserve(baseKeys.size() + recentKeys.size() + 1);
+        ids.reserve(baseIds.size() + recentCount + pairs.size());
+        size_t i = 0, r = 0, j = 0;
+        while (i < baseKeys.size() || r < recentKeys.size() || j < pairs.size()) {
+            uint32_t t = UINT32_MAX;
+            if (i < baseKeys.size()) t = min(t, baseKeys[i]);
+            if (r < recentKeys.size()) t = min(t, recentKeys[r]);
+            if (j < pairs.size()) t = min(t, pairs[j].first);
+            keys.push_back(t);
+            start.push_back(uint32_t(ids.size()));
+            if (i < baseKeys.size() && baseKeys[i] == t) {
+                ids.insert(ids.end(), baseIds.begin() + baseStart[i], baseIds.begin() + baseStart[i + 1]);
+                ++i;
+            }
+            if (r < recentKeys.size() && recentKeys[r] == t) {
+                const vector<uint32_t>& list = recent.find(t)->second;
+                ids.insert(ids.end(), list.begin(), list.end());
+                ++r;
+            }
+            for (; j < pairs.size() && pairs[j].first == t; ++j) ids.push_back(pairs[j].second);
+        }
+        start.push_back(uint32_t(ids.size()));
+        baseKeys.swap(keys);
+        baseStart.swap(start);
+        baseIds.swap(ids);
+        recent.clear();
+        recentCount = 0;
+    }
+
+public:
+    // Запрос короче триграммы индексом не ускоряется - нужен полный просмотр
+    static constexpr size_t minQuery = 3;
+
+    // Переиндексация всех продуктов (номера записей совпадают с номерами продуктов)
+    template <typename Products>
+    void rebuild(const Products& products) {
+        clear();
+        insertRange(products, 0);
+    }
+
+    // Добавление продуктов с номерами from и дальше разом: пары (триграмма, запись)
+    // сортируются и вливаются в основу одним проходом
+    template <typename Products>
+    void insertRange(const Products& products, size_t from) {
+        vector<pair<uint32_t, uint32_t>> pairs;
+        if (products.size() > idOf.size()) idOf.resize(products.size());
+        for (size_t slot = from; slot < products.size(); ++slot) {
+            uint32_t id = uint32_t(slotOf.size());
+            slotOf.push_back(uint32_t(slot));
+            idOf[slot] = id;
+            for (uint32_t t : trigramsOf(descriptionText(products, slot))) pairs.emplace_back(t, id);
+        }
+        sortPairs(pairs);
+        merge(pairs);
+    }
+
+    // Добавление продукта slot (уже лежащего в products)
+    template <typename Products>
+    void insert(const Products& products, size_t slot) {
+        uint32_t id = uint32_t(slotOf.size());
+        slotOf.push_back(uint32_t(slot));
+        if (slot >= idOf.size()) idOf.resize(slot + 1);
+        idOf[slot] = id;
+        for (uint32_t t : trigramsOf(descriptionText(products, slot))) {
+            recent[t].push_back(id);
+            ++recentCount;
+        }
+        if (recentCount > 4096 && recentCount > baseIds.size()) merge({});
+    }
+
+    // Место под expected продуктов
+    void reserve(size_t expected) {
+        slotOf.reserve(slotOf.size() + (expected > idOf.size() ? expected - idOf.size() : 0));
+        idOf.reserve(expected);
+    }
+
+    // Удаление продукта slot: запись только помечается мертвой
+    void erase(size_t slot) {
+        slotOf[idOf[slot]] = deadSlot;
+        ++dead;
+    }
+
+    // Продукт переехал из from в to (перенос последнего на место удаленного)
+    void relocate(size_t from, size_t to) {
+        idOf[to] = idOf[from];
+        slotOf[idOf[to]] = uint32_t(to);
+    }
+
+    // Переиндексация, если мертвых записей больше, чем живых продуктов
+    template <typename Products>
+    void shrink(const Products& products) {
+        if (dead > 1024 && dead > products.size()) rebuild(products);
+        else if (idOf.size() > products.size()) idOf.resize(products.size());
+    }
+
+    // Номера продуктов, в описании которых есть подстрока query (по возрастанию)
+    template <typename Products>
+    vector<size_t> find(const Products& products, const string& query) const {
+        vector<size_t> result;
+        if (query.size() < minQuery) {
+            for (size_t slot = 0; slot < products.size(); ++slot) {
+                if (descriptionText(products, slot).find(query) != string_view::npos) result.push_back(slot);
+            }
+            return result;
+        }
+
+        // Соседние триграммы одного слова почти всегда встречаются вместе, поэтому
+        // пересекаются самый короткий список в начале запроса, в конце и самый
+        // короткий вообще; остальные триграммы проверяет find
+        size_t positions = query.size() - 2;
+        Postings shortest[3]; // начало, конец, все
+        size_t found[3] = { 0, 0, 0 };
+        for (size_t i = 0; i < positions; ++i) {
+            Postings list = postingsOf(trigram(query, i));
+            if (list.size() == 0) return result;
+            for (size_t part : {i < (positions + 1) / 2 ? size_t(0) : size_t(1), size_t(2)}) {
+                if (!found[part]++ || list.size() < shortest[part].size()) shortest[part] = list;
+            }
+        }
+        vector<Postings> lists;
+        for (const Postings& list : shortest) {
+            if (found[&list - shortest] && find_if(lists.begin(), lists.end(), [&](const Postings& l) {
+                return l.head == list.head && l.tail == list.tail;
+            }) == lists.end()) {
+                lists.push_back(list);
+            }
+        }
+        // Пересечение перескоками: кандидат - наибольший из просмотренных номеров,
+        // каждый список по кругу догоняет его галопом; короткие списки первыми
+        sort(lists.begin(), lists.end(), [](const Postings& a, const Postings& b) {
+            return a.size() < b.size();
+        });
+        vector<size_t> cursor(lists.size(), 0);
+        uint32_t candidate = lists[0][0];
+        size_t agreed = 0;
+        for (size_t k = 0;; k = (k + 1) % lists.size()) {
+            const Postings& list = lists[k];
+            cursor[k] = gallop(list, cursor[k], candidate);
+            if (cursor[k] == list.size()) break;
+            if (list[cursor[k]] != candidate) {
+                candidate = list[cursor[k]];
+                agreed = 1;
+                continue;
+            }
+            if (++agreed < lists.size()) continue;
+            uint32_t slot = slotOf[candidate];
+            if (slot != deadSlot && descriptionText(products, slot).find(query) != string_view::npos) result.push_back(slot);
+            if (++cursor[k] == list.size()) break;
+            candidate = list[cursor[k]];
+            agreed = 1;
+        }
+        sort(result.begin(), result.end());
+        return result;
+    }
+
+    // Занятая память (хеш-таблица новых записей - приблизительно), байт
+    size_t memoryBytes() const {
+        size_t bytes = (baseKeys.capacity() + baseStart.capacity() + baseIds.capacity() + slotOf.capacity() + idOf.capacity()) * sizeof(uint32_t);
+        for (const auto& list : recent) bytes += list.second.capacity() * sizeof(uint32_t) + sizeof(list) + 2 * sizeof(void*);
+        return bytes + recent.bucket_count() * sizeof(void*);
+    }
+
+    void clear() {
+        baseKeys.clear();
+        baseStart.clear();
+        baseIds.clear();
+        recent.clear();
+        recentCount = 0;
+        slotOf.clear();
+        idOf.clear();
+        dead = 0;
+    }
+};
+
+// Четверичная куча продуктов склада по ключу (цене или количеству) с обратным
+// индексом номер продукта -> место в куче, поэтому продукт удаляется и меняет
+// ключ за O(log n). Ключ хранится рядом с номером: просеивание не обращается к
+// самим продуктам. Before(a, b) - ключ a должен стоять в куче выше b.
+// Вершина - за O(1), k лучших - обходом кучи от вершины за O(k log k)
+template <typename Key, typename Before>
+class SlotHeap {
+private:
+    struct Entry {
+        Key key;
+        uint32_t slot;
+    };
+
+    static constexpr size_t arity = 4; // детей у вершины: дети лежат рядом, куча ниже вдвое
+
+    vector<Entry> heap;
+    vector<uint32_t> position; // номер продукта -> индекс в heap
+    Before before;
+
+    void place(size_t at, const Entry& entry) {
+        heap[at] = entry;
+        position[entry.slot] = uint32_t(at);
+    }
+
+    void siftUp(size_t at) {
+        Entry entry = heap[at];
+        while (at > 0) {
+            size_t parent = (at - 1) / arity;
+            if (!before(entry.key, heap[parent].key)) break;
+            place(at, heap[parent]);
+            at = parent;
+        }
+        place(at, entry);
+    }
+
+    void siftDown(size_t at) {
+        Entry entry = heap[at];
+        while (true) {
+            size_t first = arity * at + 1;
+            if (first >= heap.size()) break;
+            size_t child = first;
+            for (size_t other = first + 1; other < min(first + arity, heap.size()); ++other) {
+                if (before(heap[other].key, heap[child].key)) child = other;
+            }
+            if (!before(heap[child].key, entry.key)) break;
+            place(at, heap[child]);
+            at = child;
+        }
+        place(at, entry);
+    }
+
+    // Элемент at мог нарушить порядок в любую сторону
+    void restore(size_t at) {
+        if (at > 0 && before(heap[at].key, heap[(at - 1) / arity].key)) siftUp(at);
+        else siftDown(at);
+    }
+
+public:
+    bool empty() const {
+        return heap.empty();
+    }
+
+    // Лучший продукт и его ключ (куча не пуста)
+    size_t top() const {
+        return heap[0].slot;
+    }
+    Key topKey() const {
+        return heap[0].key;
+    }
+
+    void reserve(size_t n) {
+        heap.reserve(n);
+        position.reserve(n);
+    }
+
+    // Новый продукт slot (номера добавляются подряд: slot == числу продуктов в куче)
+    void push(size_t slot, Key key) {
+        heap.push_back(Entry{ key, uint32_t(slot) });
+        position.push_back(uint32_t(heap.size() - 1));
+        siftUp(heap.size() - 1);
+    }
+
+    // Все продукты 0..count-1 заново за O(count), keyOf(slot) - ключ продукта
+    template <typename KeyOf>
+    void rebuild(size_t count, KeyOf keyOf) {
+        heap.resize(count);
+        position.resize(count);
+        for (size_t slot = 0; slot < count; ++slot) place(slot, Entry{ keyOf(slot), uint32_t(slot) });
+        for (size_t at = count / arity + 1; at-- > 0;) {
+            if (at < count) siftDown(at);
+        }
+    }
+
+    // Удаление продукта slot; на его номер переезжает последний продукт last
+    // (как в Warehouse::removeAt)
+    void remove(size_t slot, size_t last) {
+        size_t at = position[slot];
+        Entry moved = heap.back();
+        heap.pop_back();
+        if (at < heap.size()) {
+            place(at, moved);
+            restore(at);
+        }
+        if (slot != last) {
+            size_t from = position[last];
+            heap[from].slot = uint32_t(slot);
+            position[slot] = uint32_t(from);
+        }
+        position.pop_back();
+    }
+
+    // Новый ключ продукта slot
+    void update(size_t slot, Key key) {
+        size_t at = position[slot];
+        heap[at].key = key;
+        restore(at);
+    }
+
+    // До k лучших продуктов по порядку: кандидаты - дети уже выданных вершин
+    vector<size_t> best(size_t k) const {
+        vector<size_t> result;
+        auto worse = [&](uint32_t a, uint32_t b) { return before(heap[b].key, heap[a].key); };
+        priority_queue<uint32_t, vector<uint32_t>, decltype(worse)> candidates(worse);
+        if (!heap.empty()) candidates.push(0);
+        while (result.size() < k && !candidates.empty()) {
+            uint32_t at = candidates.top();
+            candidates.pop();
+            result.push_back(heap[at].slot);
+            for (size_t child = arity * size_t(at) + 1; child <= arity * size_t(at) + arity && child < heap.size(); ++child) {
+                candidates.push(uint32_t(child));
+            }
+        }
+        return result;
+    }
+
+    size_t memoryBytes() const {
+        return heap.capacity() * sizeof(Entry) + position.capacity() * sizeof(uint32_t);
+    }
+};
+
+// Сводка по запасу склада (или нескольких складов, см. merge)
+struct InventoryStats {
+    size_t products = 0;
+    long long units = 0; // сумма количеств
+    long long valueKopecks = 0; // сумма цена * количество, цена округляется до копеек
+    float minPrice = 0, maxPrice = 0; // при products == 0 - нули
+    int minQuantity = 0, maxQuantity = 0;
+
+    double value() const {
+        return double(valueKopecks) / 100.0;
+    }
+
+    void merge(const InventoryStats& other) {
+        if (other.products == 0) return;
+        if (products == 0) {
+            *this = other;
+            return;
+        }
+        products += other.products;
+        units += other.units;
+        valueKopecks += other.valueKopecks;
+        minPrice = min(minPrice, other.minPrice);
+        maxPrice = max(maxPrice, other.maxPrice);
+        minQuantity = min(minQuantity, other.minQuantity);
+        maxQuantity = max(maxQuantity, other.maxQuantity);
+    }
+};
+
+// Наибольшая допустимая цена продукта: стоимость запаса склада (до INT_MAX единиц
+// по такой цене) еще помещается в long long копеек
+constexpr float maxProductPrice = 1e7f;
+
+// Вклад продукта в стоимость запаса, копеек. Цена из снимка, журнала или трассы
+// не проверялась при вводе, поэтому насыщается до [-maxProductPrice, maxProductPrice]
+// (NaN - ноль): llround и умножение не переполняются
+inline long long valueKopecks(float price, int quantity) {
+    double clamped = isnan(price) ? 0.0 : max(-double(maxProductPrice), min(double(maxProductPrice), double(price)));
+    return llround(clamped * 100.0) * quantity;
+}
+
+// Способ хранения продуктов склада
+enum class Storage {
+    OBJECTS, // vector<Product>
+    COLUMNS // ProductColumns: плотные массивы полей, описания в пуле
+};
+
+class Warehouse;
+
+// Ссылка на продукт склада без копирования при любом способе хранения.
+// Действительна до следующего изменения склада
+class ProductRef {
+private:
+    const Warehouse* warehouse = nullptr;
+    size_t slot = 0;
+
+public:
+    ProductRef() = default;
+    ProductRef(const Warehouse* w, size_t s) : warehouse(w), slot(s) {}
+
+    // false - продукт не найден
+    explicit operator bool() const {
+        return warehouse != nullptr;
+    }
+
+    size_t getSlot() const {
+        return slot;
+    }
+
+    const Warehouse* getWarehouse() const {
+        return warehouse;
+    }
+
+    string getBarcode() const;
+    string_view getDescription() const;
+    float getPrice() const;
+    int getQuantity() const;
+    float getTransportLong() const;
+    float getTransportLat() const;
+    Product toProduct() const;
+    void print() const;
+};
+
+// Класс Warehouse
+class Warehouse {
+private:
+    string id; // идентификатор
+    WarehouseType type; // тип
+    float longitude; // долгота
+    float latitude; // широта
+    int maxCapacity; // максимальная вместимость
+    int totalStock; // общий запас
+    Storage storage = Storage::OBJECTS; // способ хранения продуктов
+    vector<Product> products; // список продуктов (OBJECTS)
+    ProductColumns columns; // продукты по колонкам (COLUMNS)
+    BarcodeIndex barcodeIndex; // штрих-код -> номер продукта
+    DescriptionIndex descriptionIndex; // триграммы описаний -> номера в products (в COLUMNS - в пуле описаний)
+    long long units = 0; // сумма количеств продуктов (totalStock может отличаться после updateStock)
+    long long valueKopecks = 0; // стоимость запаса, см. InventoryStats
+    SlotHeap<float, greater<float>> priceHigh; // продукты по цене и количеству: сверху
+    SlotHeap<float, less<float>> priceLow; // наибольшие или наименьшие
+    SlotHeap<int, greater<int>> quantityHigh;
+    SlotHeap<int, less<int>> quantityLow;
+    static atomic<int> warehouseCounter; 
+
+    friend class ProductRef;
+
+    int quantityAt(size_t slot) const {
+        return storage == Storage::COLUMNS ? columns.quantityColumn()[slot] : products[slot].getQuantity();
+    }
+
+    float priceAt(size_t slot) const {
+        return storage == Storage::COLUMNS ? columns.priceColumn()[slot] : products[slot].getPrice();
+    }
+
+    // Сводка и кучи после добавления продуктов с номерами from и дальше: поштучно
+    // или, если добавлено больше, чем было, перестройкой куч за линейное время
+    void trackAdded(size_t from) {
+        size_t count = productCount();
+        for (size_t slot = from; slot < count; ++slot) {
+            units += quantityAt(slot);
+            valueKopecks += ::valueKopecks(priceAt(slot), quantityAt(slot));
+        }
+        if (count - from > from) {
+            auto price = [this](size_t slot) { return priceAt(slot); };
+            auto quantity = [this](size_t slot) { return quantityAt(slot); };
+            priceHigh.rebuild(count, price);
+            priceLow.rebuild(count, price);
+            quantityHigh.rebuild(count, quantity);
+            quantityLow.rebuild(count, quantity);
+            return;
+        }
+        for (size_t slot = from; slot < count; ++slot) {
+            priceHigh.push(slot, priceAt(slot));
+            priceLow.push(slot, priceAt(slot));
+            quantityHigh.push(slot, quantityAt(slot));
+            quantityLow.push(slot, quantityAt(slot));
+        }
+    }
+
+    // До удаления продукта slot из хранилища (на его место встанет last)
+    void trackRemoved(size_t slot, size_t last) {
+        units -= quantityAt(slot);
+        valueKopecks -= ::valueKopecks(priceAt(slot), quantityAt(slot));
+        priceHigh.remove(slot, last);
+        priceLow.remove(slot, last);
+        quantityHigh.remove(slot, last);
+        quantityLow.remove(slot, last);
+    }
+
+    // После замены продукта slot (прежние цена и количество - price, quantity)
+    void trackUpdated(size_t slot, float price, int quantity) {
+        units += quantityAt(slot) - quantity;
+        valueKopecks += ::valueKopecks(priceAt(slot), quantityAt(slot)) - ::valueKopecks(price, quantity);
+        if (priceAt(slot) != price) {
+            priceHigh.update(slot, priceAt(slot));
+            priceLow.update(slot, priceAt(slot));
+        }
+        if (quantityAt(slot) != quantity) {
+            quantityHigh.update(slot, quantityAt(slot));
+            quantityLow.update(slot, quantityAt(slot));
+        }
+    }
+
+    // Номер продукта со штрих-кодом barcode или BarcodeIndex::notFound
+    size_t slotOf(const string& barcode) const {
+        if (storage == Storage::COLUMNS) {
+            uint64_t code;
+            if (!ProductColumns::encodeBarcode(barcode, code)) return BarcodeIndex::notFound;
+            return barcodeIndex.find(columns, code);
+        }
+        return barcodeIndex.find(products, barcode);
+    }
+
+    // Новые описания пула (с номера from) в индекс описаний
+    void indexNewDescriptions(size_t from) {
+        const DescriptionPool& pool = columns.descriptionPool();
+        if (pool.size() == from + 1) descriptionIndex.insert(pool, from);
+        else if (pool.size() > from) descriptionIndex.insertRange(pool, from);
+    }
+
+    // Сжатие пула описаний, когда в нем много неиспользуемых строк; индекс
+    // описаний тогда перестраивается по новым номерам
+    void compactDescriptions() {
+        if (columns.compact()) descriptionIndex.rebuild(columns.descriptionPool());
+    }
+
+    // Удаление продукта slot за O(1): на его место переносится последний
+    void removeAt(size_t slot) {
+        totalStock -= quantityAt(slot);
+        trackRemoved(slot, productCount() - 1);
+        if (storage == Storage::COLUMNS) {
+            barcodeIndex.erase(columns, slot);
+            if (slot != columns.size() - 1) barcodeIndex.relocate(columns, columns.size() - 1, slot);
+            columns.removeAt(slot);
+            compactDescriptions();
+            return;
+        }
+        barcodeIndex.erase(products, slot);
+        descriptionIndex.erase(slot);
+        size_t last = products.size() - 1;
+        if (slot != last) {
+            barcodeIndex.relocate(products, last, slot);
+            descriptionIndex.relocate(last, slot);
+            products[slot] = move(products[last]);
+        }
+        products.pop_back();
+        descriptionIndex.shrink(products);
+    }
+
+    // Пакет в конец хранилища, индекс описаний пополняется одним проходом (запас не меняется)
+    void appendProducts(vector<Product>&& batch) {
+        size_t first = productCount();
+        reserve(batch.size());
+        if (storage == Storage::COLUMNS) {
+            size_t known = columns.descriptionPool().size();
+            for (const Product& p : batch) {
+                columns.push_back(p);
+                barcodeIndex.insert(columns, columns.size() - 1);
+            }
+            indexNewDescriptions(known);
+        }
+        else {
+            size_t from = products.size();
+            for (Product& p : batch) {
+                products.push_back(move(p));
+                barcodeIndex.insert(products, products.size() - 1);
+            }
+            descriptionIndex.insertRange(products, from);
+        }
+        trackAdded(first);
+        batch.clear();
+    }
+
+    // Память строки вне объекта (если она не уместилась в сам string), байт
+    static size_t heapBytes(const string& text) {
+        const char* inside = reinterpret_cast<const char*>(&text);
+        bool local = text.data() >= inside && text.data() < inside + sizeof(string);
+        return local ? 0 : text.capacity() + 1;
+    }
+
+public:
+    // Конструкторы
+    Warehouse() : id(""), type(WarehouseType::CENTER), longitude(0.0), latitude(0.0), maxCapacity(0), totalStock(0) {}
+
+    Warehouse(WarehouseType t, float lon, float lat, int maxCap, Storage s = Storage::OBJECTS)
+        : type(t), longitude(lon), latitude(lat), maxCapacity(maxCap), totalStock(0), storage(s) {
+        generateId();
+    }
+
+    // Конструктор копирования
+    Warehouse(const Warehouse& other) {
+        id = other.id;
+        type = other.type;
+        longitude = other.longitude;
+        latitude = other.latitude;
+        maxCapacity = other.maxCapacity;
+        totalStock = other.totalStock;
+        storage = other.storage;
+        products = other.products;
+        columns = other.columns;
+        barcodeIndex = other.barcodeIndex;
+        descriptionIndex = other.descriptionIndex;
+        units = other.units;
+        valueKopecks = other.valueKopecks;
+        priceHigh = other.priceHigh;
+        priceLow = other.priceLow;
+        quantityHigh = other.quantityHigh;
+        quantityLow = other.quantityLow;
+    }
+
+    // Деструктор
+    ~Warehouse() {
+        products.clear();
+    }
+
+    // Генерация ID склада
+    void generateId() {
+        int code = 100 + warehouseCounter.fetch_add(1);
+        id = "W" + to_string(code);
+    }
+
+    // Поместится ли еще quantity единиц
+    bool hasRoom(int quantity) const {
+        return totalStock + quantity <= maxCapacity;
+    }
+
+    // Можно ли хранить продукт на этом складе: в COLUMNS штрих-код должен быть числом
+    bool canStore(const Product& product) const {
+        return storage != Storage::COLUMNS || ProductColumns::fits(product);
+    }
+
+    // Добавление продукта
+    bool addProduct(const Product& product) {
+        return addProduct(Product(product));
+    }
+
+    bool addProduct(Product&& product) {
+        if (hasRoom(product.getQuantity()) && canStore(product)) {
+            int quantity = product.getQuantity();
+            if (storage == Storage::COLUMNS) {
+                size_t known = columns.descriptionPool().size();
+                columns.push_back(product);
+                barcodeIndex.insert(columns, columns.size() - 1);
+                indexNewDescriptions(known);
+            }
+            else {
+                products.push_back(move(product));
+                barcodeIndex.insert(products, products.size() - 1);
+                descriptionIndex.insert(products, products.size() - 1);
+            }
+            trackAdded(productCount() - 1);
+            totalStock += quantity;
+            return true;
+        }
+        return false;
+    }
+
+    // Добавление пакета целиком, если он помещается по вместимости (иначе ничего);
+    // индекс описаний пополняется одним проходом
+    bool addProducts(vector<Product>&& batch) {
+        long long quantity = 0;
+        for (const Product& p : batch) {
+            if (!canStore(p)) return false;
+            quantity += p.getQuantity();
+        }
+        if (totalStock + quantity > maxCapacity) return false;
+        appendProducts(move(batch));
+        totalStock += int(quantity);
+        return true;
+    }
+
+    // Восстановление из снимка: продукты добавляются без проверки вместимости, общий
+    // запас становится stock (через updateStock он мог разойтись с суммой количеств)
+    bool restore(vector<Product>&& batch, int stock) {
+        for (const Product& p : batch) {
+            if (!canStore(p)) return false;
+        }
+        appendProducts(move(batch));
+        totalStock = stock;
+        return true;
+    }
+
+    // Место под еще extra продуктов: вектор и индексы не перестраиваются при добавлении
+    void reserve(size_t extra) {
+        size_t expected = productCount() + extra;
+        priceHigh.reserve(expected);
+        priceLow.reserve(expected);
+        quantityHigh.reserve(expected);
+        quantityLow.reserve(expected);
+        if (storage == Storage::COLUMNS) {
+            columns.reserve(expected);
+            barcodeIndex.reserve(columns, expected);
+            return;
+        }
+        products.reserve(expected);
+        barcodeIndex.reserve(products, expected);
+        descriptionIndex.reserve(expected);
+    }
+
+    // Удаление продукта по штрих-коду за O(1) (порядок остальных продуктов меняется:
+    // на место удаленного встает последний)
+    bool removeProduct(const string& barcode) {
+        size_t slot = slotOf(barcode);
+        if (slot == BarcodeIndex::notFound) return false;
+        removeAt(slot);
+        return true;
+    }
+
+    // Поиск продукта по штрих-коду за O(1); пустая ссылка, если не найден
+    ProductRef findByBarcode(const string& barcode) const {
+        size_t slot = slotOf(barcode);
+        return slot == BarcodeIndex::notFound ? ProductRef() : ProductRef(this, slot);
+    }
+
+    // Замена продукта со штрих-кодом barcode на updated (штрих-код тоже может смениться)
+    // с учетом вместимости склада
+    bool updateProduct(const string& barcode, const Product& updated) {
+        size_t slot = slotOf(barcode);
+        if (slot == BarcodeIndex::notFound || !canStore(updated)) return false;
+        int delta = updated.getQuantity() - quantityAt(slot);
+        if (totalStock + delta > maxCapacity) return false;
+        bool barcodeChanged = updated.getBarcode() != barcode;
+        float oldPrice = priceAt(slot);
+        int oldQuantity = quantityAt(slot);
+        if (storage == Storage::COLUMNS) {
+            if (barcodeChanged) barcodeIndex.erase(columns, slot);
+            size_t known = columns.descriptionPool().size();
+            columns.set(slot, updated);
+            if (barcodeChanged) barcodeIndex.insert(columns, slot);
+            indexNewDescriptions(known);
+            compactDescriptions();
+            trackUpdated(slot, oldPrice, oldQuantity);
+            totalStock += delta;
+            return true;
+        }
+        bool descriptionChanged = updated.getDescription() != products[slot].getDescription();
+        if (barcodeChanged) barcodeIndex.erase(products, slot);
+        if (descriptionChanged) descriptionIndex.erase(slot);
+        products[slot] = updated;
+        if (barcodeChanged) barcodeIndex.insert(products, slot);
+        if (descriptionChanged) {
+            descriptionIndex.insert(products, slot);
+            descriptionIndex.shrink(products);
+        }
+        trackUpdated(slot, oldPrice, oldQuantity);
+        totalStock += delta;
+        return true;
+    }
+
+    // Поиск продуктов по части описания через индекс триграмм (в COLUMNS индекс
+    // находит подходящие описания пула, затем обходятся только их списки продуктов).
+    // Ссылки в порядке хранения, действительны до следующего изменения склада
+    vector<ProductRef> findProduct(const string& desc) const {
+        vector<ProductRef> result;
+        if (storage == Storage::COLUMNS) {
+            vector<uint32_t> slots;
+            for (size_t text : descriptionIndex.find(columns.descriptionPool(), desc)) {
+                for (uint32_t slot = columns.firstWith(uint32_t(text)); slot != ProductColumns::noSlot; slot = columns.nextWith(slot)) {
+                    slots.push_back(slot);
+                }
+            }
+            sort(slots.begin(), slots.end());
+            result.reserve(slots.size());
+            for (uint32_t slot : slots) result.emplace_back(this, slot);
+            return result;
+        }
+        for (size_t slot : descriptionIndex.find(products, desc)) result.emplace_back(this, slot);
+        return result;
+    }
+
+    // Продукты с ценой в [minPrice, maxPrice] в порядке хранения
+    vector<ProductRef> filterByPrice(float minPrice, float maxPrice) const {
+        vector<ProductRef> result;
+        if (storage == Storage::COLUMNS) {
+            const vector<float>& prices = columns.priceColumn();
+            for (size_t slot = 0; slot < prices.size(); ++slot) {
+                if (prices[slot] >= minPrice && prices[slot] <= maxPrice) result.emplace_back(this, slot);
+            }
+            return result;
+        }
+        for (size_t slot = 0; slot < products.size(); ++slot) {
+            float price = products[slot].getPrice();
+            if (price >= minPrice && price <= maxPrice) result.emplace_back(this, slot);
+        }
+        return result;
+    }
+
+    // Суммарная стоимость запаса (цена * количество)
+    double totalValue() const {
+        double sum = 0;
+        if (storage == Storage::COLUMNS) {
+            const vector<float>& prices = columns.priceColumn();
+            const vector<int32_t>& quantities = columns.quantityColumn();
+            for (size_t slot = 0; slot < prices.size(); ++slot) sum += double(prices[slot]) * quantities[slot];
+            return sum;
+        }
+        for (const auto& product : products) sum += double(product.getPrice()) * product.getQuantity();
+        return sum;
+    }
+
+    // Сводка по запасу за O(1): поддерживается при каждом добавлении, удалении и замене
+    InventoryStats stats() const {
+        InventoryStats result;
+        result.products = productCount();
+        result.units = units;
+        result.valueKopecks = valueKopecks;
+        if (result.products) {
+            result.minPrice = priceLow.topKey();
+            result.maxPrice = priceHigh.topKey();
+            result.minQuantity = quantityLow.topKey();
+            result.maxQuantity = quantityHigh.topKey();
+        }
+        return result;
+    }
+
+    // k самых дорогих продуктов по убыванию цены, O(k log k)
+    vector<ProductRef> topByPrice(size_t k) const {
+        vector<ProductRef> result;
+        for (size_t slot : priceHigh.best(k)) result.emplace_back(this, slot);
+        return result;
+    }
+
+    // k продуктов с наибольшим количеством по убыванию, O(k log k)
+    vector<ProductRef> topByQuantity(size_t k) const {
+        vector<ProductRef> result;
+        for (size_t slot : quantityHigh.best(k)) result.emplace_back(this, slot);
+        return result;
+    }
+
+    // Память под продукты и индексы склада, байт
+    size_t memoryBytes() const {
+        size_t bytes = barcodeIndex.memoryBytes() + descriptionIndex.memoryBytes() + priceHigh.memoryBytes() +
+            priceLow.memoryBytes() + quantityHigh.memoryBytes() + quantityLow.memoryBytes();
+        if (storage == Storage::COLUMNS) return bytes + columns.memoryBytes();
+        bytes += products.capacity() * sizeof(Product);
+        for (const auto& product : products) bytes += heapBytes(product.getBarcode()) + heapBytes(product.getDescription());
+        return bytes;
+    }
+
+    // Вычисление расстояния Манхэттена
+    float calculateDistance(float productLong, float productLat) const {
+        return abs(latitude - productLat) + abs(longitude - productLong);
+    }
+
+    // Обновление общего запаса
+    void updateStock(int delta) {
+        totalStock += delta;
+    }
+
+    // Печать информации о складе
+    void print() const {
+        cout << "ID склада: " << id << endl;
+        cout << "Тип: ";
+        switch (type) {
+        case WarehouseType::CENTER:
+            cout << "центр";
+            break;
+        case WarehouseType::WEST:
+            cout << "запад";
+            break;
+        case WarehouseType::EAST:
+            cout << "восток";
+            break;
+        }
+        cout << endl;
+        cout << "Координаты: (" << longitude << ", " << latitude << ")" << endl;
+        cout << "Макс. вместимость: " << maxCapacity << endl;
+        cout << "Текущий запас: " << totalStock << endl;
+        cout << "Количество продуктов: " << productCount() << endl;
+        if (productCount() > 0) {
+            InventoryStats summary = stats();
+            cout << "Стоимость запаса: " << fixed << setprecision(2) << summary.value() << " руб." << endl;
+            cout << "Цены: от " << summary.minPrice << " до " << summary.maxPrice << " руб." << endl;
+            cout << "Количество на позицию: от " << summary.minQuantity << " до " << summary.maxQuantity << endl;
+        }
+    }
+
+    // Список продуктов
+    void listProducts() const {
+        if (productCount() == 0) {
+            cout << "Склад пуст." << endl;
+            return;
+        }
+        for (size_t slot = 0; slot < productCount(); ++slot) {
+            ProductRef(this, slot).print();
+            cout << "-------------------" << endl;
+        }
+    }
+
+    // Getters
+    string getId() const 
+    {
+        return id; 
+    }
+    WarehouseType getType() const 
+    {
+        return type; 
+    }
+    pair<float, float> getCoordinates() const 
+    {
+        return { longitude, latitude }; 
+    }
+    int getMaxCapacity() const 
+    {
+        return maxCapacity; 
+    }
+    int getTotalStock() const 
+    {
+        return totalStock; 
+    }
+    Storage getStorage() const
+    {
+        return storage;
+    }
+    size_t productCount() const
+    {
+        return storage == Storage::COLUMNS ? columns.size() : products.size();
+    }
+    vector<Product> getProducts() const 
+    {
+        if (storage == Storage::COLUMNS) {
+            vector<Product> result;
+            result.reserve(columns.size());
+            for (size_t slot = 0; slot < columns.size(); ++slot) result.push_back(columns.product(slot));
+            return result;
+        }
+        return products; 
+    }
+};
+
+string ProductRef::getBarcode() const {
+    if (warehouse->storage == Storage::COLUMNS) return ProductColumns::decodeBarcode(warehouse->columns.barcodeColumn()[slot]);
+    return warehouse->products[slot].getBarcode();
+}
+
+string_view ProductRef::getDescription() const {
+    if (warehouse->storage == Storage::COLUMNS) return warehouse->columns.descriptionPool()[warehouse->columns.descriptionColumn()[slot]];
+    return warehouse->products[slot].getDescription();
+}
+
+float ProductRef::getPrice() const {
+    if (warehouse->storage == Storage::COLUMNS) return warehouse->columns.priceColumn()[slot];
+    return warehouse->products[slot].getPrice();
+}
+
+int ProductRef::getQuantity() const {
+    return warehouse->quantityAt(slot);
+}
+
+float ProductRef::getTransportLong() const {
+    if (warehouse->storage == Storage::COLUMNS) return warehouse->columns.longitudeColumn()[slot];
+    return warehouse->products[slot].getTransportLong();
+}
+
+float ProductRef::getTransportLat() const {
+    if (warehouse->storage == Storage::COLUMNS) return warehouse->columns.latitudeColumn()[slot];
+    return warehouse->products[slot].getTransportLat();
+}
+
+Product ProductRef::toProduct() const {
+    if (warehouse->storage == Storage::COLUMNS) return warehouse->columns.product(slot);
+    return warehouse->products[slot];
+}
+
+void ProductRef::print() const {
+    if (warehouse->storage == Storage::COLUMNS) warehouse->columns.product(slot).print();
+    else warehouse->products[slot].print();
+}
+
+atomic<int> Warehouse::warehouseCounter(0);
+
+// Сводка по складам типа type за O(числа складов)
+InventoryStats statsByType(const vector<Warehouse>& warehouses, WarehouseType type) {
+    InventoryStats result;
+    for (const Warehouse& w : warehouses) {
+        if (w.getType() == type) result.merge(w.stats());
+    }
+    return result;
+}
+
+// k лучших продуктов всех складов: k лучших каждого склада (top(w, k)) сливаются по ключу key
+template <typename Top, typename Key>
+vector<ProductRef> topOverall(const vector<Warehouse>& warehouses, size_t k, Top top, Key key) {
+    vector<ProductRef> result;
+    for (const Warehouse& w : warehouses) {
+        vector<ProductRef> best = top(w, k);
+        result.insert(result.end(), best.begin(), best.end());
+    }
+    size_t keep = min(k, result.size());
+    partial_sort(result.begin(), result.begin() + keep, result.end(), [&](const ProductRef& a, const ProductRef& b) {
+        return key(a) > key(b);
+    });
+    result.resize(keep);
+    return result;
+}
+
+vector<ProductRef> topByPrice(const vector<Warehouse>& warehouses, size_t k) {
+    return topOverall(warehouses, k, [](const Warehouse& w, size_t n) { return w.topByPrice(n); },
+        [](const ProductRef& p) { return p.getPrice(); });
+}
+
+vector<ProductRef> topByQuantity(const vector<Warehouse>& warehouses, size_t k) {
+    return topOverall(warehouses, k, [](const Warehouse& w, size_t n) { return w.topByQuantity(n); },
+        [](const ProductRef& p) { return p.getQuantity(); });
+}
+
+// Генератор случайных чисел потока: у каждого потока свой, общий rand() не трогается
+mt19937& threadRandom() {
+    thread_local mt19937 gen(random_device{}() ^ uint32_t(hash<thread::id>()(this_thread::get_id())));
+    return gen;
+}
+
+// Left-right: два экземпляра данных, читатели без блокировок работают с одним, писатель
+// (один за раз) меняет другой, переключает читателей на него, дожидается ухода
+// читателей со старого экземпляра и повторяет изменение на нем. Читатель только
+// отмечается на счетчике и никогда не ждет; писатель ждет самых долгих читателей.
+// Изменение применяется дважды, поэтому должно давать одно и то же на одинаковых данных
+template <typename T>
+class LeftRight {
+private:
+    struct alignas(64) Indicator {
+        atomic<long> readers{ 0 };
+    };
+
+    T instances[2];
+    atomic<int> reading{ 0 }; // экземпляр, который видят читатели
+    atomic<int> version{ 0 }; // счетчик, на котором отмечаются новые читатели
+    mutable Indicator indicators[2];
+    mutex writers;
+
+    void waitReaders(int v) const {
+        while (indicators[v].readers.load() != 0) this_thread::yield();
+    }
+
+public:
+    explicit LeftRight(const T& initial) : instances{ initial, initial } {}
+
+    // Чтение: f(const T&) видит все завершенные изменения
+    template <typename F>
+    auto read(F f) const {
+        int v = version.load();
+        indicators[v].readers.fetch_add(1);
+        struct Depart {
+            atomic<long>& readers;
+            ~Depart() {
+                readers.fetch_sub(1);
+            }
+        } depart{ indicators[v].readers };
+        return f(instances[reading.load()]);
+    }
+
+    // Замок писателей - для изменений, которым нужно сначала посмотреть на данные
+    mutex& writerMutex() {
+        return writers;
+    }
+
+    // Данные под замком писателей (оба экземпляра в этот момент одинаковы)
+    const T& current() const {
+        return instances[reading.load()];
+    }
+
+    // Изменение под замком писателей; возвращается результат первого применения f
+    template <typename F>
+    auto writeLocked(F f) {
+        int r = reading.load();
+        auto result = f(instances[1 - r]);
+        reading.store(1 - r);
+        int v = version.load();
+        waitReaders(1 - v);
+        version.store(1 - v);
+        waitReaders(v);
+        f(instances[r]);
+        return result;
+    }
+
+    template <typename F>
+    auto write(F f) {
+        lock_guard<mutex> lock(writers);
+        return writeLocked(f);
+    }
+};
+
+// Склад для многопоточной работы: продукты разбиты по штрих-коду на шарды, у
+// каждого шарда свой писатель, так что изменения разных шардов идут параллельно,
+// а чтение (поиск, количество) не блокируется совсем (LeftRight, память шарда - вдвое).
+// Вместимость резервируется до вставки сравнением с обменом на общем счетчике
+// запаса, поэтому maxCapacity не превышается ни при каком чередовании потоков.
+// Шарды внутри - обычные Warehouse без своего ограничения вместимости
+class ConcurrentWarehouse {
+private:
+    struct alignas(64) Shard {
+        LeftRight<Warehouse> data;
+
+        explicit Shard(const Warehouse& empty) : data(empty) {}
+    };
+
+    string id;
+    int maxCapacity;
+    alignas(64) atomic<long long> stock{ 0 };
+    vector<unique_ptr<Shard>> shards;
+
+    size_t shardIndex(const string& barcode) const {
+        return BarcodeIndex::hashOf(barcode) % shards.size();
+    }
+
+    // Резерв quantity единиц: не больше maxCapacity при любых соседних резервах
+    bool reserveStock(long long quantity) {
+        long long current = stock.load();
+        do {
+            if (current + quantity > maxCapacity) return false;
+        } while (!stock.compare_exchange_weak(current, current + quantity));
+        return true;
+    }
+
+    void releaseStock(long long quantity) {
+        stock.fetch_sub(quantity);
+    }
+
+public:
+    ConcurrentWarehouse(WarehouseType t, float lon, float lat, int maxCap, size_t shardCount = 16, Storage storage = Storage::OBJECTS)
+        : maxCapacity(maxCap) {
+        Warehouse empty(t, lon, lat, numeric_limits<int>::max(), storage);
+        id = empty.getId();
+        for (size_t i = 0; i < max<size_t>(shardCount, 1); ++i) shards.emplace_back(new Shard(empty));
+    }
+
+    ConcurrentWarehouse(const ConcurrentWarehouse&) = delete;
+    ConcurrentWarehouse& operator=(const ConcurrentWarehouse&) = delete;
+
+    // Новый штрих-код на генераторе вызывающего потока
+    static string newBarcode() {
+        return Product::makeBarcode([] { return int(threadRandom()() >> 1); });
+    }
+
+    // Добавление продукта
+    bool addProduct(const Product& product) {
+        if (!reserveStock(product.getQuantity())) return false;
+        Shard& shard = *shards[shardIndex(product.getBarcode())];
+        bool added = shard.data.write([&](Warehouse& w) { return w.addProduct(product); });
+        if (!added) releaseStock(product.getQuantity());
+        return added;
+    }
+
+    // Удаление продукта по штрих-коду
+    bool removeProduct(const string& barcode) {
+        Shard& shard = *shards[shardIndex(barcode)];
+        lock_guard<mutex> lock(shard.data.writerMutex());
+        ProductRef found = shard.data.current().findByBarcode(barcode);
+        if (!found) return false;
+        int quantity = found.getQuantity();
+        shard.data.writeLocked([&](Warehouse& w) { return w.removeProduct(barcode); });
+        releaseStock(quantity);
+        return true;
+    }
+
+    // Замена продукта со штрих-кодом barcode на updated с учетом вместимости. Если
+    // штрих-код меняет шард, продукт переносится, и читатель может на мгновение
+    // не увидеть его ни в одном из двух шардов
+    bool updateProduct(const string& barcode, const Product& updated) {
+        size_t from = shardIndex(barcode), to = shardIndex(updated.getBarcode());
+        Shard& source = *shards[from];
+        Shard& target = *shards[to];
+        unique_lock<mutex> first(shards[min(from, to)]->data.writerMutex());
+        unique_lock<mutex> second;
+        if (from != to) second = unique_lock<mutex>(shards[max(from, to)]->data.writerMutex());
+
+        ProductRef found = source.data.current().findByBarcode(barcode);
+        if (!found || !target.data.current().canStore(updated)) return false;
+        int delta = updated.getQuantity() - found.getQuantity();
+        if (delta > 0 && !reserveStock(delta)) return false;
+        if (from == to) {
+            source.data.writeLocked([&](Warehouse& w) { return w.updateProduct(barcode, updated); });
+        }
+        else {
+            source.data.writeLocked([&](Warehouse& w) { return w.removeProduct(barcode); });
+            target.data.writeLocked([&](Warehouse& w) { return w.addProduct(updated); });
+        }
+        if (delta < 0) releaseStock(-delta);
+        return true;
+    }
+
+    // Изменение общего запаса без продуктов, как Warehouse::updateStock: прибавка
+    // резервируется с проверкой вместимости (false, если не помещается), убыль
+    // возвращается в счетчик. Шарды не меняются
+    bool updateStock(int delta) {
+        if (delta > 0) return reserveStock(delta);
+        if (delta < 0) releaseStock(-(long long)delta);
+        return true;
+    }
+
+    // f(const ProductRef&) над продуктом со штрих-кодом barcode без копирования;
+    // ссылку нельзя сохранять после возврата из f. false, если не найден
+    template <typename F>
+    bool withProduct(const string& barcode, F f) const {
+        return shards[shardIndex(barcode)]->data.read([&](const Warehouse& w) {
+            ProductRef found = w.findByBarcode(barcode);
+            if (found) f(found);
+            return bool(found);
+        });
+    }
+
+    // Копия продукта со штрих-кодом barcode в out; false, если не найден
+    bool findByBarcode(const string& barcode, Product& out) const {
+        return withProduct(barcode, [&](const ProductRef& found) { out = found.toProduct(); });
+    }
+
+    // Копии продуктов с подстрокой desc в описании (по шардам)
+    vector<Product> findProduct(const string& desc) const {
+        vector<Product> result;
+        for (const auto& shard : shards) {
+            shard->data.read([&](const Warehouse& w) {
+                for (const ProductRef& p : w.findProduct(desc)) result.push_back(p.toProduct());
+                return 0;
+            });
+        }
+        return result;
+    }
+
+    size_t productCount() const {
+        size_t count = 0;
+        for (const auto& shard : shards) count += shard->data.read([](const Warehouse& w) { return w.productCount(); });
+        return count;
+    }
+
+    // Сумма запаса по шардам (для проверки: совпадает с getTotalStock без параллельных
+    // изменений, если не вызывался updateStock)
+    long long shardStock() const {
+        long long sum = 0;
+        for (const auto& shard : shards) sum += shard->data.read([](const Warehouse& w) { return w.getTotalStock(); });
+        return sum;
+    }
+
+    string getId() const {
+        return id;
+    }
+    int getMaxCapacity() const {
+        return maxCapacity;
+    }
+    long long getTotalStock() const {
+        return stock.load();
+    }
+};
+
+// Метрика расстояния между точкой транспортировки и складом
+enum class Metric {
+    MANHATTAN, // |dДолгота| + |dШирота| в градусах, как в Warehouse::calculateDistance
+    EUCLIDEAN, // по плоскости (долгота, широта) в градусах
+    GREAT_CIRCLE // по поверхности Земли, км
+};
+
+// k-d дерево над точками размерности D, хранимое неявно: корень поддерева [lo, hi)
+// лежит в середине отрезка, ось разбиения выбирается по наибольшему разбросу.
+// Отсечение по расстоянию до плоскости разбиения годится для L1 и L2.
+// Точкам можно дать веса (SubtreeMax - максимум веса по поддеревьям), тогда
+// поиск не заходит в поддеревья, где нет точки с весом не меньше требуемого
+class KdTree {
+public:
+    static constexpr size_t maxDim = 3;
+    using Point = array<double, maxDim>;
+
+    // Найденная точка: номер (как при построении) и расстояние
+    struct Hit {
+        size_t index;
+        double distance;
+    };
+
+    // Максимумы весов по поддеревьям (по месту корня поддерева в дереве)
+    using SubtreeMax = vector<long long>;
+
+private:
+    size_t dim = 2;
+    vector<Point> points; // в порядке дерева
+    vector<uint32_t> ids; // номера точек в исходном порядке
+    vector<uint8_t> axes; // ось разбиения узла
+    vector<uint32_t> positions; // номер точки -> место в дереве
+
+    void build(size_t lo, size_t hi) {
+        if (hi - lo <= 1) return;
+        size_t axis = 0;
+        double widest = -1;
+        for (size_t a = 0; a < dim; ++a) {
+            auto range = minmax_element(points.begin() + lo, points.begin() + hi, [a](const Point& x, const Point& y) {
+                return x[a] < y[a];
+            });
+            if ((*range.second)[a] - (*range.first)[a] > widest) {
+                widest = (*range.second)[a] - (*range.first)[a];
+                axis = a;
+            }
+        }
+        size_t mid = lo + (hi - lo) / 2;
+        vector<uint32_t> order(ids.begin() + lo, ids.begin() + hi);
+        vector<Point> source(points.begin() + lo, points.begin() + hi);
+        vector<uint32_t> local(hi - lo);
+        for (size_t i = 0; i < local.size(); ++i) local[i] = uint32_t(i);
+        nth_element(local.begin(), local.begin() + (mid - lo), local.end(), [&](uint32_t x, uint32_t y) {
+            return source[x][axis] < source[y][axis];
+        });
+        for (size_t i = 0; i < local.size(); ++i) {
+            points[lo + i] = source[local[i]];
+            ids[lo + i] = order[local[i]];
+        }
+        axes[mid] = uint8_t(axis);
+        build(lo, mid);
+        build(mid + 1, hi);
+    }
+
+    long long fillMax(vector<long long>& best, const vector<long long>& weights, size_t lo, size_t hi) const {
+        if (lo >= hi) return numeric_limits<long long>::min();
+        size_t mid = lo + (hi - lo) / 2;
+        best[mid] = max({ weights[ids[mid]], fillMax(best, weights, lo, mid), fillMax(best, weights, mid + 1, hi) });
+        return best[mid];
+    }
+
+    // Отбор: не больше k ближайших в пределах radius, прошедших accept. В куче -
+    // худший из отобранных сверху; равные расстояния упорядочены по номеру
+    template <typename Distance, typename Accept>
+    struct Collector {
+        const Point& query;
+        Distance distance;
+        Accept accept;
+        size_t k;
+        double radius;
+        const vector<long long>* subtreeMax; // nullptr - без весов
+        long long need;
+        vector<pair<double, size_t>> heap;
+
+        double bound() const {
+            return heap.size() == k ? heap.front().first : radius;
+        }
+
+        void offer(const Point& p, size_t id) {
+            double d = distance(query, p);
+            if (d > bound()) return;
+            if (heap.size() == k) {
+                if (!(make_pair(d, id) < heap.front()) || !accept(id)) return;
+                pop_heap(heap.begin(), heap.end());
+                heap.back() = { d, id };
+            } else {
+                if (!accept(id)) return;
+                heap.emplace_back(d, id);
+            }
+            push_heap(heap.begin(), heap.end());
+        }
+    };
+
+    template <typename C>
+    void search(size_t lo, size_t hi, C& collector) const {
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (collector.subtreeMax && (*collector.subtreeMax)[mid] < collector.need) return;
+            collector.offer(points[mid], ids[mid]);
+            if (hi - lo == 1) return;
+            double diff = collector.query[axes[mid]] - points[mid][axes[mid]];
+            // Сначала сторона запроса, дальняя - только если плоскость не дальше границы
+            size_t nearLo = diff < 0 ? lo : mid + 1, nearHi = diff < 0 ? mid : hi;
+            size_t farLo = diff < 0 ? mid + 1 : lo, farHi = diff < 0 ? hi : mid;
+            search(nearLo, nearHi, collector);
+            if (abs(diff) > collector.bound()) return;
+            lo = farLo;
+            hi = farHi;
+        }
+    }
+
+public:
+    KdTree() = default;
+
+    KdTree(const vector<Point>& source, size_t dimension) : dim(dimension), points(source), ids(source.size()), axes(source.size()) {
+        for (size_t i = 0; i < ids.size(); ++i) ids[i] = uint32_t(i);
+        build(0, points.size());
+        positions.resize(ids.size());
+        for (size_t i = 0; i < ids.size(); ++i) positions[ids[i]] = uint32_t(i);
+    }
+
+    SubtreeMax subtreeMax(const vector<long long>& weights) const {
+        SubtreeMax result(points.size());
+        fillMax(result, weights, 0, points.size());
+        return result;
+    }
+
+    // Вес точки index стал weights[index]: пересчет максимумов на пути от корня
+    void updateMax(SubtreeMax& best, const vector<long long>& weights, size_t index) const {
+        size_t target = positions[index];
+        pair<size_t, size_t> path[64];
+        size_t depth = 0;
+        for (size_t lo = 0, hi = points.size();;) {
+            size_t mid = lo + (hi - lo) / 2;
+            path[depth++] = { lo, hi };
+            if (mid == target) break;
+            if (target < mid) hi = mid;
+            else lo = mid + 1;
+        }
+        while (depth > 0) {
+            size_t lo = path[depth - 1].first, hi = path[depth - 1].second;
+            --depth;
+            size_t mid = lo + (hi - lo) / 2;
+            long long value = weights[ids[mid]];
+            if (lo < mid) value = max(value, best[lo + (mid - lo) / 2]);
+            if (mid + 1 < hi) value = max(value, best[mid + 1 + (hi - mid - 1) / 2]);
+            best[mid] = value;
+        }
+    }
+
+    size_t size() const {
+        return points.size();
+    }
+
+    // До k ближайших к query точек на расстоянии не больше radius среди прошедших
+    // accept(номер), по возрастанию расстояния
+    template <typename Distance, typename Accept>
+    vector<Hit> nearest(const Point& query, size_t k, double radius, Distance distance, Accept accept) const {
+        if (k == 0) return {};
+        Collector<Distance, Accept> collector{ query, distance, accept, k, radius, nullptr, 0, {} };
+        return collect(collector);
+    }
+
+    // То же только среди точек с весом не меньше need (best - subtreeMax текущих весов)
+    template <typename Distance, typename Accept>
+    vector<Hit> nearest(const Point& query, size_t k, double radius, Distance distance, Accept accept,
+        const SubtreeMax& best, long long need) const {
+        if (k == 0) return {};
+        Collector<Distance, Accept> collector{ query, distance, accept, k, radius, &best, need, {} };
+        return collect(collector);
+    }
+
+private:
+    template <typename C>
+    vector<Hit> collect(C& collector) const {
+        vector<Hit> result;
+        search(0, points.size(), collector);
+        sort_heap(collector.heap.begin(), collector.heap.end());
+        for (const auto& hit : collector.heap) result.push_back(Hit{ hit.second, hit.first });
+        return result;
+    }
+};
+
+// Пространственный индекс складов: ближайший, k ближайших и все в радиусе для
+// Manhattan и Euclidean по координатам склада и для расстояния по дуге большого
+// круга. Дуга монотонна по хорде между точками единичной сферы, поэтому для нее
+// дерево строится по трехмерным точкам и ищет по хорде.
+// Индекс хранит номера складов в векторе, по которому построен; склады должны
+// оставаться на месте (координаты складов не меняются, добавлять склады - rebuild)
+class WarehouseIndex {
+public:
+    using Hit = KdTree::Hit;
+    static constexpr size_t notFound = SIZE_MAX;
+    static constexpr double earthRadiusKm = 6371.0;
+
+    // Остатки вместимости складов для пакетного размещения с максимумами по
+    // поддеревьям обоих деревьев: склады без места отсекаются целыми поддеревьями
+    struct Room {
+        vector<long long> left;
+        KdTree::SubtreeMax plane, sphere;
+    };
+
+private:
+    KdTree plane; // (долгота, широта)
+    KdTree sphere; // точки единичной сферы
+
+    static KdTree::Point toPlane(float lon, float lat) {
+        return KdTree::Point{ lon, lat, 0.0 };
+    }
+
+    static KdTree::Point toSphere(float lon, float lat) {
+        const double degree = acos(-1.0) / 180.0;
+        double phi = lat * degree, lambda = lon * degree;
+        return KdTree::Point{ cos(phi) * cos(lambda), cos(phi) * sin(lambda), sin(phi) };
+    }
+
+    static double chordToKm(double chord) {
+        return 2 * earthRadiusKm * asin(min(1.0, chord / 2));
+    }
+
+    static double kmToChord(double km) {
+        if (km >= acos(-1.0) * earthRadiusKm) return numeric_limits<double>::infinity();
+        return 2 * sin(km / (2 * earthRadiusKm));
+    }
+
+    static double manhattan(const KdTree::Point& a, const KdTree::Point& b) {
+        return abs(a[0] - b[0]) + abs(a[1] - b[1]);
+    }
+
+    static double euclidean(const KdTree::Point& a, const KdTree::Point& b) {
+        return sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+    }
+
+    template <typename Distance, typename Accept>
+    static vector<Hit> search(const KdTree& tree, const KdTree::Point& point, size_t k, double radius, Distance distance,
+        Accept accept, const KdTree::SubtreeMax* best, long long need) {
+        return best ? tree.nearest(point, k, radius, distance, accept, *best, need) : tree.nearest(point, k, radius, distance, accept);
+    }
+
+    // Поиск по метрике; с room - только среди складов, где осталось не меньше need
+    template <typename Accept>
+    vector<Hit> query(float lon, float lat, Metric metric, size_t k, double radius, Accept accept,
+        const Room* room = nullptr, long long need = 0) const {
+        switch (metric) {
+        case Metric::MANHATTAN:
+            return search(plane, toPlane(lon, lat), k, radius, manhattan, accept, room ? &room->plane : nullptr, need);
+        case Metric::EUCLIDEAN:
+            return search(plane, toPlane(lon, lat), k, radius, euclidean, accept, room ? &room->plane : nullptr, need);
+        case Metric::GREAT_CIRCLE: {
+            vector<Hit> hits = search(sphere, toSphere(lon, lat), k, kmToChord(radius), euclidean, accept,
+                room ? &room->sphere : nullptr, need);
+            for (Hit& hit : hits) hit.distance = chordToKm(hit.distance);
+            return hits;
+        }
+        }
+        return {};
+    }
+
+public:
+    WarehouseIndex() = default;
+
+    explicit WarehouseIndex(const vector<Warehouse>& warehouses) {
+        rebuild(warehouses);
+    }
+
+    void rebuild(const vector<Warehouse>& warehouses) {
+        vector<KdTree::Point> flat, round;
+        for (const Warehouse& w : warehouses) {
+            pair<float, float> c = w.getCoordinates();
+            flat.push_back(toPlane(c.first, c.second));
+            round.push_back(toSphere(c.first, c.second));
+        }
+        plane = KdTree(flat, 2);
+        sphere = KdTree(round, 3);
+    }
+
+    // Расстояние от точки до склада в единицах метрики (для проверки и эталонов)
+    static double distance(const Warehouse& w, float lon, float lat, Metric metric) {
+        pair<float, float> c = w.getCoordinates();
+        switch (metric) {
+        case Metric::MANHATTAN:
+            return manhattan(toPlane(c.first, c.second), toPlane(lon, lat));
+        case Metric::EUCLIDEAN:
+            return euclidean(toPlane(c.first, c.second), toPlane(lon, lat));
+        case Metric::GREAT_CIRCLE:
+            return chordToKm(euclidean(toSphere(c.first, c.second), toSphere(lon, lat)));
+        }
+        return 0;
+    }
+
+    // Ближайший склад; index == notFound, если складов нет
+    Hit nearest(float lon, float lat, Metric metric) const {
+        vector<Hit> hits = kNearest(lon, lat, metric, 1);
+        return hits.empty() ? Hit{ notFound, 0 } : hits[0];
+    }
+
+    // k ближайших складов по возрастанию расстояния (при равенстве - по номеру)
+    vector<Hit> kNearest(float lon, float lat, Metric metric, size_t k) const {
+        return query(lon, lat, metric, k, numeric_limits<double>::infinity(), [](size_t) { return true; });
+    }
+
+    // Все склады не дальше radius по возрастанию расстояния
+    vector<Hit> withinRadius(float lon, float lat, Metric metric, double radius) const {
+        return query(lon, lat, metric, SIZE_MAX, radius, [](size_t) { return true; });
+    }
+
+    // Ближайший склад, прошедший accept(номер склада); index == notFound, если таких нет
+    template <typename Accept>
+    Hit nearestMatching(float lon, float lat, Metric metric, Accept accept) const {
+        vector<Hit> hits = query(lon, lat, metric, 1, numeric_limits<double>::infinity(), accept);
+        return hits.empty() ? Hit{ notFound, 0 } : hits[0];
+    }
+
+    // Ближайший склад, куда помещается quantity единиц; index == notFound, если таких нет
+    Hit nearestWithRoom(const vector<Warehouse>& warehouses, float lon, float lat, Metric metric, int quantity) const {
+        return nearestMatching(lon, lat, metric, [&](size_t i) { return warehouses[i].hasRoom(quantity); });
+    }
+
+    // Остатки вместимости складов на текущий момент
+    Room trackRoom(const vector<Warehouse>& warehouses) const {
+        Room room;
+        for (const Warehouse& w : warehouses) room.left.push_back((long long)w.getMaxCapacity() - w.getTotalStock());
+        room.plane = plane.subtreeMax(room.left);
+        room.sphere = sphere.subtreeMax(room.left);
+        return room;
+    }
+
+    // Ближайший склад, где по room осталось не меньше quantity; index == notFound, если таких нет
+    Hit nearestWithRoom(const Room& room, float lon, float lat, Metric metric, int quantity) const {
+        vector<Hit> hits = query(lon, lat, metric, 1, numeric_limits<double>::infinity(), [&](size_t i) {
+            return room.left[i] >= quantity;
+        }, &room, quantity);
+        return hits.empty() ? Hit{ notFound, 0 } : hits[0];
+    }
+
+    // Склад index принимает quantity единиц
+    void take(Room& room, size_t index, int quantity) const {
+        room.left[index] -= quantity;
+        plane.updateMax(room.plane, room.left, index);
+        sphere.updateMax(room.sphere, room.left, index);
+    }
+
+    // Размещение продукта на ближайшем складе, а если он заполнен - на следующем
+    // по удаленности, где хватает места. Номер склада или notFound
+    size_t route(vector<Warehouse>& warehouses, const Product& product, Metric metric) const {
+        Hit hit = nearestWithRoom(warehouses, product.getTransportLong(), product.getTransportLat(), metric, product.getQuantity());
+        if (hit.index == notFound || !warehouses[hit.index].addProduct(product)) return notFound;
+        return hit.index;
+    }
+};
+
+// ===== Пакетная загрузка продуктов =====
+//
+// CSV: строка "описание;цена;количество;долгота;широта[;штрих-код]", описание
+// можно взять в кавычки (кавычка внутри удваивается), строки с # пропускаются.
+// Без штрих-кода он генерируется, как при вводе из меню.
+// Двоичный формат: "PWB1", uint64 число записей, затем записи
+// { float цена, int32 количество, float долгота, float широта,
+//   uint16 длина описания, uint8 длина штрих-кода, описание, штрих-код }.
+
+// Отклоненная запись: номер строки CSV или записи двоичного файла (с 1) и причина
+struct IngestReject {
+    size_t record;
+    string reason;
+};
+
+// Прочитанный пакет: продукты, номера их записей в файле и отклоненные при разборе
+struct ProductBatch {
+    vector<Product> products;
+    vector<size_t> records;
+    vector<IngestReject> rejected;
+};
+
+// Итог загрузки
+struct IngestReport {
+    size_t accepted = 0;
+    long long units = 0; // принятое количество единиц
+    vector<size_t> perWarehouse; // принято продуктов по складам
+    vector<IngestReject> rejected; // по возрастанию номера записи
+};
+
+const char productsMagic[4] = { 'P', 'W', 'B', '1' };
+// Запись без описания и штрих-кода: цена, количество, координаты и две длины
+constexpr size_t minProductRecord = 4 * sizeof(float) + sizeof(uint16_t) + sizeof(uint8_t);
+
+// Проверка и нормализация полей, как в createProduct; пустая строка - продукт годен
+string checkProduct(string& desc, float price, int quantity, float tLong, float tLat) {
+    if (!isfinite(price) || price < 0) return "некорректная цена";
+    if (price > maxProductPrice) return "цена больше 10000000";
+    if (quantity <= 0) return "некорректное количество";
+    if (!isfinite(tLong) || !isfinite(tLat)) return "некорректные координаты";
+    if (!(tLong >= 19.0f && tLong <= 169.0f)) return "долгота вне 19-169";
+    if (!(tLat >= 41.0f && tLat <= 82.0f)) return "широта вне 41-82";
+    if (desc.length() > 50) desc = desc.substr(0, 50);
+    return "";
+}
+
+// Поля строки CSV через ';' с учетом кавычек
+vector<string> splitCsv(const string& line) {
+    vector<string> fields(1);
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                fields.back() += '"';
+                ++i;
+            }
+            else if (c == '"') quoted = false;
+            else fields.back() += c;
+        }
+        else if (c == '"') quoted = true;
+        else if (c == ';') fields.emplace_back();
+        else if (c != '\r') fields.back() += c;
+    }
+    return fields;
+}
+
+// Число из всего поля целиком
+bool parseNumber(const string& field, float& value) {
+    char* end = nullptr;
+    value = strtof(field.c_str(), &end);
+    return !field.empty() && *end == '\0';
+}
+
+bool parseNumber(const string& field, int& value) {
+    char* end = nullptr;
+    long parsed = strtol(field.c_str(), &end, 10);
+    value = int(parsed);
+    return !field.empty() && *end == '\0' && parsed == value;
+}
+
+bool readProductsCsv(const string& path, ProductBatch& batch) {
+    ifstream in(path);
+    if (!in) return false;
+    string line;
+    for (size_t record = 1; getline(in, line); ++record) {
+        if (line.empty() || line[0] == '#' || line == "\r") continue;
+        vector<string> fields = splitCsv(line);
+        float price, tLong, tLat;
+        int quantity;
+        if (fields.size() < 5 || fields.size() > 6 || !parseNumber(fields[1], price) || !parseNumber(fields[2], quantity) ||
+            !parseNumber(fields[3], tLong) || !parseNumber(fields[4], tLat)) {
+            batch.rejected.push_back({ record, "ошибка разбора" });
+            continue;
+        }
+        string reason = checkProduct(fields[0], price, quantity, tLong, tLat);
+        if (!reason.empty()) {
+            batch.rejected.push_back({ record, reason });
+            continue;
+        }
+        batch.products.emplace_back(move(fields[0]), price, quantity, tLong, tLat);
+        if (fields.size() == 6 && !fields[5].empty()) batch.products.back().setBarcode(move(fields[5]));
+        batch.records.push_back(record);
+    }
+    return true;
+}
+
+bool readProductsBinary(const string& path, ProductBatch& batch) {
+    ifstream in(path, ios::binary);
+    char magic[4];
+    uint64_t count = 0;
+    if (!in.read(magic, 4) || memcmp(magic, productsMagic, 4) != 0 || !in.read((char*)&count, sizeof(count))) return false;
+    // Число записей из файла не проверено: резерв - не больше, чем в нем умещается,
+    // а нехватка данных обнаружится при чтении как "файл обрывается"
+    streamoff start = in.tellg();
+    in.seekg(0, ios::end);
+    size_t fits = size_t(in.tellg() - start) / minProductRecord;
+    in.seekg(start);
+    batch.products.reserve(batch.products.size() + size_t(min<uint64_t>(count, fits)));
+    batch.records.reserve(batch.records.size() + size_t(min<uint64_t>(count, fits)));
+    string desc, barcode;
+    for (uint64_t record = 1; record <= count; ++record) {
+        float price, tLong, tLat;
+        int32_t quantity;
+        uint16_t descLength;
+        uint8_t barcodeLength;
+        in.read((char*)&price, sizeof(price)).read((char*)&quantity, sizeof(quantity));
+        in.read((char*)&tLong, sizeof(tLong)).read((char*)&tLat, sizeof(tLat));
+        in.read((char*)&descLength, sizeof(descLength)).read((char*)&barcodeLength, sizeof(barcodeLength));
+        desc.resize(descLength);
+        barcode.resize(barcodeLength);
+        in.read(&desc[0], descLength).read(&barcode[0], barcodeLength);
+        if (!in) {
+            batch.rejected.push_back({ size_t(record), "файл обрывается" });
+            return true;
+        }
+        string reason = checkProduct(desc, price, quantity, tLong, tLat);
+        if (!reason.empty()) {
+            batch.rejected.push_back({ size_t(record), reason });
+            continue;
+        }
+        batch.products.emplace_back(desc, price, quantity, tLong, tLat);
+        if (barcodeLength) batch.products.back().setBarcode(barcode);
+        batch.records.push_back(size_t(record));
+    }
+    return true;
+}
+
+bool writeProductsBinary(const string& path, const vector<Product>& products) {
+    ofstream out(path, ios::binary);
+    uint64_t count = products.size();
+    out.write(productsMagic, 4).write((const char*)&count, sizeof(count));
+    for (const Product& p : products) {
+        float price = p.getPrice(), tLong = p.getTransportLong(), tLat = p.getTransportLat();
+        int32_t quantity = p.getQuantity();
+        uint16_t descLength = uint16_t(min<size_t>(p.getDescription().size(), UINT16_MAX));
+        uint8_t barcodeLength = uint8_t(min<size_t>(p.getBarcode().size(), UINT8_MAX));
+        out.write((const char*)&price, sizeof(price)).write((const char*)&quantity, sizeof(quantity));
+        out.write((const char*)&tLong, sizeof(tLong)).write((const char*)&tLat, sizeof(tLat));
+        out.write((const char*)&descLength, sizeof(descLength)).write((const char*)&barcodeLength, sizeof(barcodeLength));
+        out.write(p.getDescription().data(), descLength).write(p.getBarcode().data(), barcodeLength);
+    }
+    return bool(out);
+}
+
+// Размещение пакета за один проход: сначала каждому продукту в порядке пакета
+// назначается ближайший склад, где по остатку вместимости хватает места (жадно,
+// как при поштучном добавлении, но заполненные склады отсекаются в дереве по
+// максимуму остатка), затем продукты без копирования переносятся на склады
+// группами - с одним резервированием и одним пополнением индексов на склад
+IngestReport ingestProducts(vector<Warehouse>& warehouses, const WarehouseIndex& index, ProductBatch&& batch, Metric metric) {
+    IngestReport report;
+    report.perWarehouse.assign(warehouses.size(), 0);
+    report.rejected = move(batch.rejected);
+
+    WarehouseIndex::Room room = index.trackRoom(warehouses);
+    vector<uint32_t> target(batch.products.size());
+    for (size_t i = 0; i < batch.products.size(); ++i) {
+        const Product& p = batch.products[i];
+        size_t w = index.nearestWithRoom(room, p.getTransportLong(), p.getTransportLat(), metric, p.getQuantity()).index;
+        if (w == WarehouseIndex::notFound || !warehouses[w].canStore(p)) {
+            target[i] = UINT32_MAX;
+            report.rejected.push_back({ batch.records[i], w == WarehouseIndex::notFound ? "нет склада с местом" : "штрих-код не число" });
+            continue;
+        }
+        target[i] = uint32_t(w);
+        index.take(room, w, p.getQuantity());
+        ++report.perWarehouse[w];
+    }
+
+    vector<vector<Product>> groups(warehouses.size());
+    for (size_t w = 0; w < warehouses.size(); ++w) groups[w].reserve(report.perWarehouse[w]);
+    for (size_t i = 0; i < batch.products.size(); ++i) {
+        if (target[i] == UINT32_MAX) continue;
+        report.units += batch.products[i].getQuantity();
+        groups[target[i]].push_back(move(batch.products[i]));
+        ++report.accepted;
+    }
+    for (size_t w = 0; w < warehouses.size(); ++w) {
+        if (!groups[w].empty()) warehouses[w].addProducts(move(groups[w]));
+    }
+    sort(report.rejected.begin(), report.rejected.end(), [](const IngestReject& a, const IngestReject& b) {
+        return a.record < b.record;
+    });
+    return report;
+}
+
+// Загрузка файла (.bin - двоичный формат, иначе CSV); false, если файл не открылся
+bool ingestFile(vector<Warehouse>& warehouses, const WarehouseIndex& index, const string& path, Metric metric, IngestReport& report) {
+    ProductBatch batch;
+    bool binary = path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+    if (!(binary ? readProductsBinary(path, batch) : readProductsCsv(path, batch))) return false;
+    report = ingestProducts(warehouses, index, move(batch), metric);
+    return true;
+}
+
+// ===== Журнал операций и снимки складов =====
+//
+// Состояние складов меню хранится в двух файлах:
+//   <имя>.snap - снимок всех складов на момент операции с номером seq;
+//   <имя>.log  - журнал операций после снимка, только дописывается.
+// При запуске снимок отображается в память и разбирается за один проход, затем
+// применяются операции журнала с номером больше seq. Запись журнала:
+//   { uint32 длина тела, uint32 CRC-32 тела, тело: uint64 номер, uint8 операция,
+//     uint16 номер склада, данные операции }.
+// Оборванный при сбое хвост журнала (короткая запись, неверная CRC) отбрасывается.
+// Записи копятся в буфере, отдельный поток пишет буфер и вызывает fdatasync -
+// все записи, накопившиеся за время одной синхронизации, уходят следующей одной
+// (групповая фиксация), поэтому fsync не ограничивает число операций в секунду.
+// Если подтверждения никто не ждет, буфер пишется раз в flushDelay или по flushBytes.
+// Снимок "PWS1": uint32 число складов, uint64 seq, затем по складам
+//   { uint64 число продуктов, int32 общий запас, uint32 число различных описаний,
+//     описания { uint16 длина, байты },
+//     продукты { float цена, int32 количество, float долгота, float широта,
+//                uint32 номер описания, uint8 длина штрих-кода, штрих-код } },
+// в конце "PWSE". Снимок пишется во временный файл и заменяет старый
+// переименованием, после чего журнал очищается.
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+// Сброс данных файла на диск
+bool syncFile(int fd) {
+#ifdef _WIN32
+    return _commit(fd) == 0;
+#else
+    return fdatasync(fd) == 0;
+#endif
+}
+
+bool truncateFile(int fd, size_t size) {
+#ifdef _WIN32
+    return _chsize_s(fd, (long long)size) == 0;
+#else
+    return ftruncate(fd, off_t(size)) == 0;
+#endif
+}
+
+// Сброс каталога файла path (чтобы переименование пережило сбой питания)
+void syncDirectory(const string& path) {
+#ifndef _WIN32
+    size_t slash = path.rfind('/');
+    string dir = slash == string::npos ? "." : path.substr(0, max<size_t>(slash, 1));
+    int fd = open(dir.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+#endif
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        auto written = write(fd, data, (unsigned)min<size_t>(size, 1 << 30));
+        if (written <= 0) return false;
+        data += written;
+        size -= size_t(written);
+    }
+    return true;
+}
+
+uint32_t crc32(const char* data, size_t size) {
+    static const array<uint32_t, 256> table = [] {
+        array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) crc = table[(crc ^ uint8_t(data[i])) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// Файл, отображенный в память только для чтения (без mmap - прочитанный целиком).
+// Отсутствующий или пустой файл - size() == 0
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    string copy;
+
+public:
+    explicit MappedFile(const string& path) {
+#ifdef _WIN32
+        ifstream in(path, ios::binary);
+        copy.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        bytes = copy.data();
+        length = copy.size();
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapped = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                madvise(mapped, size_t(info.st_size), MADV_SEQUENTIAL);
+                bytes = static_cast<const char*>(mapped);
+                length = size_t(info.st_size);
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (length) munmap(const_cast<char*>(bytes), length);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const {
+        return bytes;
+    }
+    size_t size() const {
+        return length;
+    }
+};
+
+// Последовательное чтение значений из памяти с проверкой границ
+class ByteReader {
+private:
+    const char* at;
+    const char* end;
+
+public:
+    ByteReader(const char* data, size_t size) : at(data), end(data + size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (size_t(end - at) < sizeof(T)) return false;
+        memcpy(&value, at, sizeof(T));
+        at += sizeof(T);
+        return true;
+    }
+
+    // Следующие size байт как строка (без копирования)
+    bool get(string_view& text, size_t size) {
+        if (size_t(end - at) < size) return false;
+        text = string_view(at, size);
+        at += size;
+        return true;
+    }
+
+    size_t left() const {
+        return size_t(end - at);
+    }
+};
+
+template <typename T>
+void putValue(string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Продукт в записи журнала - как запись двоичного файла PWB1
+void putProduct(string& out, const Product& p) {
+    uint16_t descLength = uint16_t(min<size_t>(p.getDescription().size(), UINT16_MAX));
+    uint8_t barcodeLength = uint8_t(min<size_t>(p.getBarcode().size(), UINT8_MAX));
+    putValue(out, p.getPrice());
+    putValue(out, int32_t(p.getQuantity()));
+    putValue(out, p.getTransportLong());
+    putValue(out, p.getTransportLat());
+    putValue(out, descLength);
+    putValue(out, barcodeLength);
+    out.append(p.getDescription().data(), descLength).append(p.getBarcode().data(), barcodeLength);
+}
+
+bool getProduct(ByteReader& in, Product& p) {
+    float price, tLong, tLat;
+    int32_t quantity;
+    uint16_t descLength;
+    uint8_t barcodeLength;
+    string_view desc, barcode;
+    if (!in.get(price) || !in.get(quantity) || !in.get(tLong) || !in.get(tLat) || !in.get(descLength) ||
+        !in.get(barcodeLength) || !in.get(desc, descLength) || !in.get(barcode, barcodeLength)) {
+        return false;
+    }
+    p.setDescription(string(desc));
+    p.setBarcode(string(barcode));
+    p.setPrice(price);
+    p.setQuantity(quantity);
+    p.setTransportLong(tLong);
+    p.setTransportLat(tLat);
+    return true;
+}
+
+// Запись во временный буфер с выгрузкой в файл крупными кусками
+class FileWriter {
+private:
+    int fd;
+    string buffer;
+    bool ok;
+
+public:
+    explicit FileWriter(const string& path) {
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644);
+        ok = fd >= 0;
+    }
+
+    ~FileWriter() {
+        if (fd >= 0) close(fd);
+    }
+
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    // Буфер для дописывания; выгружается в flushIfFull
+    string& out() {
+        return buffer;
+    }
+
+    void flushIfFull() {
+        if (buffer.size() >= (1 << 20)) {
+            ok = ok && writeAll(fd, buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+
+    // Остаток буфера в файл и на диск
+    bool finish() {
+        ok = ok && writeAll(fd, buffer.data(), buffer.size()) && syncFile(fd);
+        buffer.clear();
+        return ok;
+    }
+};
+
+enum class JournalOp : uint8_t {
+    ADD = 1, // продукт
+    REMOVE, // uint8 длина, штрих-код
+    UPDATE_STOCK, // int32 изменение запаса
+    UPDATE // uint8 длина, прежний штрих-код, новый продукт
+};
+
+// Журнал операций над складами vector<Warehouse> (склад задается номером в векторе)
+// и снимки. Порядок работы: recover при запуске, затем после каждого удавшегося
+// изменения склада - log* и, перед тем как сообщить о результате, waitDurable.
+// Склады меняет и снимки делает один поток; log* можно вызывать из нескольких
+class WarehouseJournal {
+public:
+    // Итог восстановления
+    struct Recovery {
+        size_t snapshotProducts = 0; // продуктов из снимка
+        size_t replayed = 0; // применено операций журнала
+        size_t droppedBytes = 0; // отброшен оборванный хвост журнала, байт
+    };
+
+    static constexpr size_t snapshotLogBytes = 64 << 20; // журнал длиннее - пора сделать снимок
+    static constexpr size_t flushBytes = 1 << 20; // столько записей пишется, не дожидаясь паузы
+    static constexpr chrono::milliseconds flushDelay{ 5 }; // пауза, если подтверждения никто не ждет
+
+private:
+    static constexpr char snapshotMagic[4] = { 'P', 'W', 'S', '1' };
+    static constexpr char snapshotEnd[4] = { 'P', 'W', 'S', 'E' };
+
+    string snapshotPath, logPath;
+    int fd = -1;
+    mutex lock;
+    condition_variable wake; // буфер не пуст или пора остановиться
+    condition_variable synced; // запись буфера закончилась
+    string pending; // записи, еще не переданные в файл
+    uint64_t nextSeq = 1;
+    uint64_t durableSeq = 0; // записи с номерами до этого на диске
+    size_t logBytes = 0;
+    size_t syncs = 0;
+    size_t waiters = 0; // потоков в waitDurable
+    bool writing = false, stopping = false, failed = false;
+    thread flusher;
+
+    void flushLoop() {
+        unique_lock<mutex> guard(lock);
+        string batch;
+        while (true) {
+            wake.wait(guard, [&] { return stopping || !pending.empty(); });
+            if (pending.empty()) return;
+            // Пока подтверждения никто не ждет, записи копятся - меньше fsync на операцию
+            wake.wait_for(guard, flushDelay, [&] { return stopping || waiters > 0 || pending.size() >= flushBytes; });
+            batch.swap(pending);
+            uint64_t upto = nextSeq - 1;
+            writing = true;
+            guard.unlock();
+            bool ok = writeAll(fd, batch.data(), batch.size()) && syncFile(fd);
+            batch.clear();
+            guard.lock();
+            writing = false;
+            failed = failed || !ok;
+            durableSeq = upto;
+            ++syncs;
+            synced.notify_all();
+        }
+    }
+
+    // Запись с телом body (номер в начале тела заполняется здесь)
+    uint64_t append(string& body) {
+        lock_guard<mutex> guard(lock);
+        uint64_t seq = nextSeq++;
+        memcpy(&body[0], &seq, sizeof(seq));
+        bool first = pending.empty();
+        putValue(pending, uint32_t(body.size()));
+        putValue(pending, crc32(body.data(), body.size()));
+        pending += body;
+        logBytes += 2 * sizeof(uint32_t) + body.size();
+        if (first || pending.size() >= flushBytes) wake.notify_one();
+        return seq;
+    }
+
+    static string startRecord(JournalOp op, size_t warehouse) {
+        string body;
+        putValue(body, uint64_t(0));
+        putValue(body, uint8_t(op));
+        putValue(body, uint16_t(warehouse));
+        return body;
+    }
+
+    // Разбор снимка идет по порядку, а индексы каждого склада строятся в своем
+    // потоке, пока разбирается следующий
+    static bool loadSnapshot(const MappedFile& file, vector<Warehouse>& warehouses, uint64_t& seq, size_t& products) {
+        ByteReader in(file.data(), file.size());
+        string_view magic, end;
+        uint32_t count;
+        if (!in.get(magic, 4) || magic != string_view(snapshotMagic, 4) || !in.get(count) || !in.get(seq) ||
+            count != warehouses.size()) {
+            return false;
+        }
+        for (const Warehouse& warehouse : warehouses) {
+            if (warehouse.productCount() != 0) return false;
+        }
+        vector<thread> builders;
+        atomic<bool> restored(true);
+        bool parsed = parseSnapshot(in, warehouses, products, [&](Warehouse& warehouse, vector<Product>&& batch, int stock) {
+            builders.emplace_back([&warehouse, &restored, stock](vector<Product>&& owned) {
+                if (!warehouse.restore(move(owned), stock)) restored = false;
+            }, move(batch));
+        });
+        for (thread& builder : builders) builder.join();
+        return parsed && restored && in.get(end, 4) && end == string_view(snapshotEnd, 4) && in.left() == 0;
+    }
+
+    // Склады снимка по очереди: restore(склад, продукты, запас)
+    template <typename Restore>
+    static bool parseSnapshot(ByteReader& in, vector<Warehouse>& warehouses, size_t& products, Restore restore) {
+        vector<string> texts;
+        for (Warehouse& warehouse : warehouses) {
+            uint64_t size;
+            int32_t stock;
+            uint32_t textCount;
+            if (!in.get(size) || !in.get(stock) || !in.get(textCount) || size > in.left() || textCount > in.left()) return false;
+            texts.resize(textCount);
+            for (string& text : texts) {
+                uint16_t length;
+                string_view bytes;
+                if (!in.get(length) || !in.get(bytes, length)) return false;
+                text = string(bytes);
+            }
+            vector<Product> batch(size);
+            for (Product& p : batch) {
+                float price, tLong, tLat;
+                int32_t quantity;
+                uint32_t text;
+                uint8_t barcodeLength;
+                string_view barcode;
+                if (!in.get(price) || !in.get(quantity) || !in.get(tLong) || !in.get(tLat) || !in.get(text) ||
+                    text >= textCount || !in.get(barcodeLength) || !in.get(barcode, barcodeLength)) {
+                    return false;
+                }
+                p.setDescription(texts[text]);
+                p.setBarcode(string(barcode));
+                p.setPrice(price);
+                p.setQuantity(quantity);
+                p.setTransportLong(tLong);
+                p.setTransportLat(tLat);
+            }
+            restore(warehouse, move(batch), stock);
+            products += size;
+        }
+        return true;
+    }
+
+    static bool writeSnapshot(const string& path, const vector<Warehouse>& warehouses, uint64_t seq) {
+        FileWriter file(path);
+        string& out = file.out();
+        out.append(snapshotMagic, 4);
+        putValue(out, uint32_t(warehouses.size()));
+        putValue(out, seq);
+        unordered_map<string_view, uint32_t> numbers;
+        vector<uint32_t> textOf;
+        for (const Warehouse& warehouse : warehouses) {
+            // Различные описания склада по порядку первого появления (string_view
+            // ссылаются на строки склада, он не меняется, пока пишется снимок)
+            size_t count = warehouse.productCount();
+            numbers.clear();
+            textOf.resize(count);
+            vector<string_view> texts;
+            for (size_t slot = 0; slot < count; ++slot) {
+                string_view text = ProductRef(&warehouse, slot).getDescription();
+                auto inserted = numbers.emplace(text, uint32_t(texts.size()));
+                if (inserted.second) texts.push_back(text);
+                textOf[slot] = inserted.first->second;
+            }
+            putValue(out, uint64_t(count));
+            putValue(out, int32_t(warehouse.getTotalStock()));
+            putValue(out, uint32_t(texts.size()));
+            for (string_view text : texts) {
+                uint16_t length = uint16_t(min<size_t>(text.size(), UINT16_MAX));
+                putValue(out, length);
+                out.append(text.data(), length);
+                file.flushIfFull();
+            }
+            for (size_t slot = 0; slot < count; ++slot) {
+                ProductRef p(&warehouse, slot);
+                string barcode = p.getBarcode();
+                uint8_t barcodeLength = uint8_t(min<size_t>(barcode.size(), UINT8_MAX));
+                putValue(out, p.getPrice());
+                putValue(out, int32_t(p.getQuantity()));
+                putValue(out, p.getTransportLong());
+                putValue(out, p.getTransportLat());
+                putValue(out, textOf[slot]);
+                putValue(out, barcodeLength);
+                out.append(barcode.data(), barcodeLength);
+                file.flushIfFull();
+            }
+        }
+        out.append(snapshotEnd, 4);
+        return file.finish();
+    }
+
+    // Применение тела записи журнала; false - запись испорчена. Удаление и изменение
+    // по штрих-коду попадают в тот же продукт, что и на живом складе: при дубликатах
+    // BarcodeIndex выбирает наименьший номер, а снимок сохраняет порядок номеров
+    static bool apply(ByteReader& in, uint8_t op, uint16_t w, vector<Warehouse>& warehouses) {
+        if (w >= warehouses.size()) return false;
+        Warehouse& warehouse = warehouses[w];
+        string_view barcode;
+        uint8_t length;
+        Product product;
+        switch (JournalOp(op)) {
+        case JournalOp::ADD:
+            if (!getProduct(in, product)) return false;
+            warehouse.addProduct(move(product));
+            return true;
+        case JournalOp::REMOVE:
+            if (!in.get(length) || !in.get(barcode, length)) return false;
+            warehouse.removeProduct(string(barcode));
+            return true;
+        case JournalOp::UPDATE_STOCK: {
+            int32_t delta;
+            if (!in.get(delta)) return false;
+            warehouse.updateStock(delta);
+            return true;
+        }
+        case JournalOp::UPDATE:
+            if (!in.get(length) || !in.get(barcode, length) || !getProduct(in, product)) return false;
+            warehouse.updateProduct(string(barcode), product);
+            return true;
+        }
+        return false;
+    }
+
+public:
+    // base - путь без расширения: base.snap и base.log
+    explicit WarehouseJournal(const string& base) : snapshotPath(base + ".snap"), logPath(base + ".log") {
+        fd = open(logPath.c_str(), O_RDWR | O_CREAT | O_APPEND | O_BINARY, 0644);
+        failed = fd < 0;
+        flusher = thread(&WarehouseJournal::flushLoop, this);
+    }
+
+    // Оставшиеся в буфере записи дописываются
+    ~WarehouseJournal() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        flusher.join();
+        if (fd >= 0) close(fd);
+    }
+
+    WarehouseJournal(const WarehouseJournal&) = delete;
+    WarehouseJournal& operator=(const WarehouseJournal&) = delete;
+
+    // Восстановление пустых складов warehouses (тех же, в том же порядке, что при
+    // записи) из снимка и журнала; до любых log*. false - файлы не подходят к складам
+    bool recover(vector<Warehouse>& warehouses, Recovery& report) {
+        report = Recovery();
+        uint64_t snapshotSeq = 0;
+        {
+            MappedFile snapshot(snapshotPath);
+            if (snapshot.size() && !loadSnapshot(snapshot, warehouses, snapshotSeq, report.snapshotProducts)) return false;
+        }
+        MappedFile log(logPath);
+        ByteReader in(log.data(), log.size());
+        uint64_t lastSeq = snapshotSeq;
+        size_t valid = 0;
+        while (true) {
+            uint32_t size, crc;
+            string_view body;
+            if (!in.get(size) || !in.get(crc) || !in.get(body, size) || crc32(body.data(), body.size()) != crc) break;
+            ByteReader record(body.data(), body.size());
+            uint64_t seq;
+            uint8_t op;
+            uint16_t w;
+            if (!record.get(seq) || !record.get(op) || !record.get(w)) break;
+            if (seq > snapshotSeq) {
+                if (!apply(record, op, w, warehouses)) break;
+                ++report.replayed;
+            }
+            lastSeq = max(lastSeq, seq);
+            valid = log.size() - in.left();
+        }
+        report.droppedBytes = log.size() - valid;
+        lock_guard<mutex> guard(lock);
+        if (report.droppedBytes && !truncateFile(fd, valid)) failed = true;
+        logBytes = valid;
+        nextSeq = lastSeq + 1;
+        durableSeq = lastSeq;
+        return true;
+    }
+
+    uint64_t logAdd(size_t warehouse, const Product& product) {
+        string body = startRecord(JournalOp::ADD, warehouse);
+        putProduct(body, product);
+        return append(body);
+    }
+
+    uint64_t logRemove(size_t warehouse, const string& barcode) {
+        string body = startRecord(JournalOp::REMOVE, warehouse);
+        putValue(body, uint8_t(min<size_t>(barcode.size(), UINT8_MAX)));
+        body.append(barcode, 0, UINT8_MAX);
+        return append(body);
+    }
+
+    uint64_t logUpdateStock(size_t warehouse, int delta) {
+        string body = startRecord(JournalOp::UPDATE_STOCK, warehouse);
+        putValue(body, int32_t(delta));
+        return append(body);
+    }
+
+    uint64_t logUpdate(size_t warehouse, const string& barcode, const Product& updated) {
+        string body = startRecord(JournalOp::UPDATE, warehouse);
+        putValue(body, uint8_t(min<size_t>(barcode.size(), UINT8_MAX)));
+        body.append(barcode, 0, UINT8_MAX);
+        putProduct(body, updated);
+        return append(body);
+    }
+
+    // Ожидание, пока запись seq (и все до нее) окажется на диске; false - ошибка записи
+    bool waitDurable(uint64_t seq) {
+        unique_lock<mutex> guard(lock);
+        if (durableSeq < seq) {
+            ++waiters;
+            wake.notify_one();
+            synced.wait(guard, [&] { return durableSeq >= seq; });
+            --waiters;
+        }
+        return !failed;
+    }
+
+    // Все записанные до сих пор операции - на диск
+    bool commit() {
+        uint64_t last;
+        {
+            lock_guard<mutex> guard(lock);
+            last = nextSeq - 1;
+        }
+        return waitDurable(last);
+    }
+
+    bool needsSnapshot() {
+        lock_guard<mutex> guard(lock);
+        return logBytes > snapshotLogBytes;
+    }
+
+    // Снимок складов (в них применены все записанные операции) и очистка журнала.
+    // Сбой между заменой снимка и очисткой не страшен: записи с номерами не больше
+    // номера снимка при восстановлении пропускаются
+    bool snapshot(const vector<Warehouse>& warehouses) {
+        uint64_t seq;
+        {
+            lock_guard<mutex> guard(lock);
+            seq = nextSeq - 1;
+        }
+        string temp = snapshotPath + ".tmp";
+        if (!writeSnapshot(temp, warehouses, seq)) {
+            remove(temp.c_str());
+            return false;
+        }
+#ifdef _WIN32
+        remove(snapshotPath.c_str());
+#endif
+        if (rename(temp.c_str(), snapshotPath.c_str()) != 0) return false;
+        syncDirectory(snapshotPath);
+
+        unique_lock<mutex> guard(lock);
+        synced.wait(guard, [&] { return pending.empty() && !writing; });
+        if (!truncateFile(fd, 0)) return false;
+        logBytes = 0;
+        return !failed;
+    }
+
+    // Сколько раз журнал сбрасывался на диск
+    size_t syncCount() {
+        lock_guard<mutex> guard(lock);
+        return syncs;
+    }
+};
+
+// ===== Трасса операций =====
+//
+// Текстовый файл, одна операция в строке, поля через ';' (как в CSV загрузки,
+// текст можно взять в кавычки), строки с # пропускаются:
+//   add;описание;цена;количество;долгота;широта;штрих-код - на ближайший склад с местом
+//   remove;штрих-код[;склад]   - склад 1-3, без него - со всех по очереди до первого
+//   find;часть описания       - поиск по описанию на всех складах
+//   lookup;штрих-код          - поиск по штрих-коду на всех складах
+//   info[;склад]              - сводка склада (без номера - всех), как пункт 5 меню
+//   measure                   - операции выше - подготовка, счетчики обнуляются
+// Меню пишет трассу с ключом --record (пункты 1, 3, 4 и 5; загрузка из файла не
+// пишется), воспроизводит ее prod_ware --replay.
+
+enum class TraceOp {
+    ADD,
+    REMOVE,
+    FIND,
+    LOOKUP,
+    INFO,
+    MEASURE
+};
+
+const char* const traceOpNames[] = { "add", "remove", "find", "lookup", "info", "measure" };
+
+struct TraceEntry {
+    TraceOp op;
+    Product product; // add
+    string text; // штрих-код или часть описания
+    int warehouse = 0; // remove, info: 1-3, 0 - все склады
+};
+
+// Поле трассы: в кавычках, если в нем есть ';', кавычка или края с пробелами
+string traceField(const string& text) {
+    bool plain = text.find_first_of(";\"\r\n") == string::npos && (text.empty() || (text.front() != ' ' && text.back() != ' '));
+    if (plain) return text;
+    string quoted = "\"";
+    for (char c : text) {
+        if (c == '\n' || c == '\r') continue;
+        quoted += c;
+        if (c == '"') quoted += '"';
+    }
+    return quoted + "\"";
+}
+
+void writeTraceEntry(ostream& out, const TraceEntry& entry) {
+    out << traceOpNames[int(entry.op)];
+    switch (entry.op) {
+    case TraceOp::ADD: {
+        const Product& p = entry.product;
+        out << ';' << traceField(p.getDescription()) << ';' << setprecision(9) << p.getPrice() << ';' << p.getQuantity()
+            << ';' << p.getTransportLong() << ';' << p.getTransportLat() << ';' << traceField(p.getBarcode());
+        break;
+    }
+    case TraceOp::REMOVE:
+        out << ';' << traceField(entry.text);
+        if (entry.warehouse) out << ';' << entry.warehouse;
+        break;
+    case TraceOp::FIND:
+    case TraceOp::LOOKUP:
+        out << ';' << traceField(entry.text);
+        break;
+    case TraceOp::INFO:
+        if (entry.warehouse) out << ';' << entry.warehouse;
+        break;
+    case TraceOp::MEASURE:
+        break;
+    }
+    out << '\n';
+}
+
+// Разбор строки трассы; false - строка неверна
+bool parseTraceLine(const string& line, TraceEntry& entry) {
+    vector<string> fields = splitCsv(line);
+    size_t op = 0;
+    while (op < size(traceOpNames) && fields[0] != traceOpNames[op]) ++op;
+    if (op == size(traceOpNames)) return false;
+    entry = TraceEntry();
+    entry.op = TraceOp(op);
+    int warehouse = 0;
+    bool hasWarehouse = false;
+    switch (entry.op) {
+    case TraceOp::ADD: {
+        float price, tLong, tLat;
+        int quantity;
+        if (fields.size() != 7 || !parseNumber(fields[2], price) || !parseNumber(fields[3], quantity) ||
+            !parseNumber(fields[4], tLong) || !parseNumber(fields[5], tLat)) {
+            return false;
+        }
+        entry.product.setDescription(fields[1]);
+        entry.product.setPrice(price);
+        entry.product.setQuantity(quantity);
+        entry.product.setTransportLong(tLong);
+        entry.product.setTransportLat(tLat);
+        entry.product.setBarcode(fields[6]);
+        return true;
+    }
+    case TraceOp::REMOVE:
+        if (fields.size() < 2 || fields.size() > 3) return false;
+        entry.text = fields[1];
+        hasWarehouse = fields.size() == 3;
+        if (hasWarehouse && !parseNumber(fields[2], warehouse)) return false;
+        break;
+    case TraceOp::FIND:
+    case TraceOp::LOOKUP:
+        if (fields.size() != 2) return false;
+        entry.text = fields[1];
+        return true;
+    case TraceOp::INFO:
+        if (fields.size() > 2) return false;
+        hasWarehouse = fields.size() == 2;
+        if (hasWarehouse && !parseNumber(fields[1], warehouse)) return false;
+        break;
+    case TraceOp::MEASURE:
+        return fields.size() == 1;
+    }
+    if (hasWarehouse && (warehouse < 1 || warehouse > 3)) return false;
+    entry.warehouse = warehouse;
+    return true;
+}
+
+// Чтение трассы; неверные строки - в rejected (номер строки с 1 и причина)
+bool readTrace(const string& path, vector<TraceEntry>& trace, vector<IngestReject>& rejected) {
+    ifstream in(path);
+    if (!in) return false;
+    string line;
+    TraceEntry entry;
+    for (size_t record = 1; getline(in, line); ++record) {
+        if (line.empty() || line[0] == '#' || line == "\r") continue;
+        if (parseTraceLine(line, entry)) trace.push_back(move(entry));
+        else rejected.push_back({ record, "неверная операция" });
+    }
+    return true;
+}
+
+bool writeTrace(const string& path, const vector<TraceEntry>& trace) {
+    ofstream out(path);
+    out << "# трасса операций prod_ware (см. --replay)\n";
+    for (const TraceEntry& entry : trace) writeTraceEntry(out, entry);
+    return bool(out);
+}
+
+// Функция для создания продукта
+Product createProduct() {
+    string desc;
+    float price;
+    int quantity;
+    float tLong, tLat;
+
+    cout << "Введите описание продукта (до 50 символов): ";
+    cin.ignore();
+    getline(cin, desc);
+    if (desc.length() > 50) desc = desc.substr(0, 50);
+
+    cout << "Введите цену продукта (0-10000000): ";
+    while (!(cin >> price) || !isfinite(price) || price < 0 || price > maxProductPrice) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Некорректная цена, введите число от 0 до 10000000: ";
+    }
+
+    cout << "Введите количество: ";
+    cin >> quantity;
+
+    cout << "Введите долготу транспортировки (19-169): ";
+    cin >> tLong;
+    tLong = max(19.0f, min(169.0f, tLong));
+
+    cout << "Введите широту транспортировки (41-82): ";
+    cin >> tLat;
+    tLat = max(41.0f, min(82.0f, tLat));
+
+    return Product(desc, price, quantity, tLong, tLat);
+}
+
+// Главное меню; trace - куда записывать операции (nullptr - никуда)
+void menu(ostream* trace) {
+    vector<Warehouse> warehouses = {
+        Warehouse(WarehouseType::CENTER, 55.75, 37.62, 1000),  
+        Warehouse(WarehouseType::WEST, 59.94, 30.31, 800),     
+        Warehouse(WarehouseType::EAST, 56.83, 60.60, 1200)      
+    };
+    WarehouseIndex warehouseIndex(warehouses);
+
+    // Склады прошлого запуска: снимок prod_ware.snap и журнал prod_ware.log
+    WarehouseJournal journal("prod_ware");
+    WarehouseJournal::Recovery recovery;
+    if (!journal.recover(warehouses, recovery)) {
+        cout << "Файлы prod_ware.snap/prod_ware.log повреждены или записаны для других складов." << endl;
+        cout << "Удалите их, чтобы начать с пустых складов." << endl;
+        return;
+    }
+    if (recovery.snapshotProducts || recovery.replayed) {
+        cout << "Восстановлено: продуктов из снимка " << recovery.snapshotProducts << ", операций журнала "
+             << recovery.replayed << endl;
+    }
+    if (recovery.droppedBytes) cout << "Отброшен оборванный хвост журнала: " << recovery.droppedBytes << " байт" << endl;
+
+    while (true) {
+        cout << "\n=== Меню управления складами ===" << endl;
+        cout << "1. Добавить продукт на склад" << endl;
+        cout << "2. Просмотреть продукты на складе" << endl;
+        cout << "3. Поиск продукта по описанию" << endl;
+        cout << "4. Удалить продукт" << endl;
+        cout << "5. Информация о складах" << endl;
+        cout << "6. Загрузить продукты из файла (CSV или .bin)" << endl;
+        cout << "7. Сводка: стоимость по типам складов, самые дорогие и многочисленные позиции" << endl;
+        cout << "0. Выход" << endl;
+        cout << endl << "Выберите действие: ";
+
+        int choice;
+        cin >> choice;
+
+        cout << endl;
+
+        if (choice == 0) {
+            if (!journal.snapshot(warehouses)) cout << "Не удалось сохранить снимок складов!" << endl;
+            break;
+        }
+
+        switch (choice) {
+        case 1: {
+            Product p = createProduct();
+            if (trace) writeTraceEntry(*trace, { TraceOp::ADD, p, "", 0 });
+
+            // Ближайший склад по Манхэттену, при переполнении - следующий по удаленности
+            size_t best = warehouseIndex.route(warehouses, p, Metric::MANHATTAN);
+            if (best != WarehouseIndex::notFound) {
+                if (!journal.waitDurable(journal.logAdd(best, p))) cout << "Ошибка записи журнала!" << endl;
+                cout << "Продукт добавлен на склад " << warehouses[best].getId() << endl;
+            }
+            else {
+                cout << "Все склады переполнены!" << endl;
+            }
+            break;
+        }
+        case 2: {
+            cout << "Выберите склад (1-Центр, 2-Запад, 3-Восток): ";
+            int wh;
+            cin >> wh;
+            if (wh >= 1 && wh <= 3) {
+                warehouses[wh - 1].listProducts();
+            }
+            else {
+                cout << "Неверный выбор!" << endl;
+            }
+            break;
+        }
+        case 3: {
+            string desc;
+            cout << "Введите часть описания для поиска: ";
+            cin.ignore();
+            getline(cin, desc);
+            if (trace) writeTraceEntry(*trace, { TraceOp::FIND, Product(), desc, 0 });
+
+            for (int i = 0; i < warehouses.size(); ++i) {
+                vector<ProductRef> found = warehouses[i].findProduct(desc);
+                if (!found.empty()) {
+                    cout << "\nНайдено на складе " << warehouses[i].getId() << ":" << endl;
+                    for (const ProductRef& p : found) {
+                        p.print();
+                        cout << "-------------------" << endl;
+                    }
+                }
+            }
+            break;
+        }
+        case 4: {
+            cout << "Выберите склад (1-Центр, 2-Запад, 3-Восток): ";
+            int wh;
+            cin >> wh;
+            if (wh < 1 || wh > 3) {
+                cout << "Неверный выбор!" << endl;
+                break;
+            }
+
+            string barcode;
+            cout << "Введите штрих-код продукта для удаления: ";
+            cin >> barcode;
+            if (trace) writeTraceEntry(*trace, { TraceOp::REMOVE, Product(), barcode, wh });
+
+            if (warehouses[wh - 1].removeProduct(barcode)) {
+                if (!journal.waitDurable(journal.logRemove(wh - 1, barcode))) cout << "Ошибка записи журнала!" << endl;
+                cout << "Продукт удален." << endl;
+            }
+            else {
+                cout << "Продукт не найден!" << endl;
+            }
+            break;
+        }
+        case 5: {
+            if (trace) writeTraceEntry(*trace, { TraceOp::INFO, Product(), "", 0 });
+            for (const auto& wh : warehouses) {
+                wh.print();
+                cout << "===================" << endl;
+            }
+            break;
+        }
+        case 6: {
+            string path;
+            cout << "Введите путь к файлу: ";
+            cin.ignore();
+            getline(cin, path);
+
+            IngestReport report;
+            if (!ingestFile(warehouses, warehouseIndex, path, Metric::MANHATTAN, report)) {
+                cout << "Не удалось открыть файл!" << endl;
+                break;
+            }
+            // Пакет целиком попадает в снимок, а не в журнал по одному продукту
+            if (report.accepted && !journal.snapshot(warehouses)) cout << "Не удалось сохранить снимок складов!" << endl;
+            cout << "Принято продуктов: " << report.accepted << " (" << report.units << " ед.)" << endl;
+            for (size_t i = 0; i < warehouses.size(); ++i) {
+                cout << "  склад " << warehouses[i].getId() << ": " << report.perWarehouse[i] << endl;
+            }
+            cout << "Отклонено: " << report.rejected.size() << endl;
+            for (size_t i = 0; i < report.rejected.size() && i < 20; ++i) {
+                cout << "  запись " << report.rejected[i].record << ": " << report.rejected[i].reason << endl;
+            }
+            break;
+        }
+        case 7: {
+            const pair<WarehouseType, const char*> types[] = { { WarehouseType::CENTER, "центр" },
+                { WarehouseType::WEST, "запад" }, { WarehouseType::EAST, "восток" } };
+            for (const auto& type : types) {
+                InventoryStats summary = statsByType(warehouses, type.first);
+                cout << type.second << ": продуктов " << summary.products << ", единиц " << summary.units
+                     << ", стоимость " << fixed << setprecision(2) << summary.value() << " руб." << endl;
+            }
+            auto list = [](const char* title, const vector<ProductRef>& top) {
+                cout << endl << title << ":" << endl;
+                for (const ProductRef& p : top) {
+                    cout << "  " << p.getBarcode() << " " << p.getDescription() << " - " << p.getPrice() << " руб., "
+                         << p.getQuantity() << " шт. (склад " << p.getWarehouse()->getId() << ")" << endl;
+                }
+            };
+            list("Самые дорогие", topByPrice(warehouses, 5));
+            list("Больше всего единиц", topByQuantity(warehouses, 5));
+            break;
+        }
+        default:
+            cout << "Неверный выбор!" << endl;
+        }
+        if (journal.needsSnapshot() && !journal.snapshot(warehouses)) cout << "Не удалось сохранить снимок складов!" << endl;
+    }
+}
+
+// ===== Бенчмарки (запуск: prod_ware --bench [раздел]) =====
+
+// Время однократного выполнения f, мс
+template <typename F>
+double measureMs(F f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Продукты со случайными штрих-кодами generateBarcode (возможны повторы)
+vector<Product> randomProducts(size_t n) {
+    vector<Product> result;
+    result.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        result.emplace_back("товар " + to_string(i), 10.0f + float(i % 1000), 1, 19.0f + float(i % 150), 41.0f + float(i % 41));
+    }
+    return result;
+}
+
+void benchBarcode() {
+    cout << "== barcode ==" << endl;
+    mt19937 gen(1);
+
+    for (size_t n : {size_t(20000), size_t(1000000), size_t(4000000)}) {
+        vector<Product> items = randomProducts(n);
+        vector<string> order;
+        order.reserve(n);
+        for (const Product& p : items) order.push_back(p.getBarcode());
+        shuffle(order.begin(), order.end(), gen);
+
+        // Исходный способ: линейный поиск и vector::erase (только для малого n - O(n^2))
+        if (n <= 20000) {
+            vector<Product> linear = items;
+            double t = measureMs([&] {
+                for (const string& barcode : order) {
+                    for (auto it = linear.begin(); it != linear.end(); ++it) {
+                        if (it->getBarcode() == barcode) {
+                            linear.erase(it);
+                            break;
+                        }
+                    }
+                }
+            });
+            cout << n << " SKU, линейное удаление: " << t * 1e6 / double(n) << " нс/удаление" << endl;
+        }
+
+        Warehouse w(WarehouseType::CENTER, 55.75f, 37.62f, numeric_limits<int>::max());
+        double add = measureMs([&] {
+            for (const Product& p : items) w.addProduct(p);
+        });
+        size_t hits = 0;
+        double find = measureMs([&] {
+            for (const string& barcode : order) hits += bool(w.findByBarcode(barcode));
+        });
+        double update = measureMs([&] {
+            for (size_t i = 0; i < n; i += 4) {
+                Product changed = w.findByBarcode(order[i]).toProduct();
+                changed.setQuantity(2);
+                w.updateProduct(order[i], changed);
+            }
+        });
+        size_t removed = 0;
+        double remove = measureMs([&] {
+            for (const string& barcode : order) removed += w.removeProduct(barcode);
+        });
+        cout << n << " SKU, индекс: добавление " << add * 1e6 / double(n) << " нс, поиск " << find * 1e6 / double(n)
+             << " нс, обновление " << update * 4e6 / double(n) << " нс, удаление " << remove * 1e6 / double(n)
+             << " нс; найдено " << hits << ", удалено " << removed << ", осталось " << w.getProducts().size()
+             << ", запас " << w.getTotalStock() << endl;
+    }
+    cout << endl;
+}
+
+// Описания из словаря: "<прилагательное> <товар> <марка> <номер>"
+vector<Product> describedProducts(size_t n, mt19937& gen) {
+    static const vector<string> adjectives = { "свежий", "большой", "малый", "красный", "зеленый", "сухой",
+        "зимний", "летний", "детский", "садовый", "прочный", "легкий" };
+    static const vector<string> nouns = { "молоко", "сыр", "хлеб", "чайник", "молоток", "гвоздь", "кабель",
+        "ботинок", "шарф", "фонарь", "ковер", "стул", "диван", "насос", "шланг", "ключ" };
+    static const vector<string> brands = { "Север", "Полюс", "Вектор", "Орбита", "Заря", "Волна", "Ладога",
+        "Алтай", "Таймыр", "Байкал" };
+    vector<Product> result;
+    result.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        string desc = adjectives[gen() % adjectives.size()] + " " + nouns[gen() % nouns.size()] + " " +
+            brands[gen() % brands.size()] + " " + to_string(gen() % 100000);
+        result.emplace_back(desc, 100.0f, 1, 0.0f, 0.0f);
+    }
+    return result;
+}
+
+// Эталон: полный просмотр, как в исходном findProduct
+vector<const Product*> scanProducts(const vector<Product>& products, const string& desc) {
+    vector<const Product*> result;
+    for (const auto& product : products) {
+        if (product.getDescription().find(desc) != string::npos) result.push_back(&product);
+    }
+    return result;
+}
+
+void benchSearch() {
+    cout << "== search ==" << endl;
+    mt19937 gen(2);
+    const vector<string> queries = { "молоток Заря", "ключ Байкал 12", "4242", "Ладога 9999", "ковер", "ый ша",
+        "Ор", "нет такого" };
+
+    for (size_t n : {size_t(100000), size_t(2000000)}) {
+        Warehouse w(WarehouseType::CENTER, 55.75f, 37.62f, numeric_limits<int>::max());
+        vector<Product> items = describedProducts(n, gen);
+        double add = measureMs([&] {
+            for (const Product& p : items) w.addProduct(p);
+        });
+        cout << n << " SKU, добавление с индексами: " << add * 1e6 / double(n) << " нс/продукт" << endl;
+
+        // Половина товаров удаляется в случайном порядке, затем поиск на изменившемся складе
+        for (int round = 0; round < 2; ++round) {
+            vector<Product> stored = w.getProducts();
+            for (const string& q : queries) {
+                vector<ProductRef> found;
+                double indexed = measureMs([&] { found = w.findProduct(q); });
+                vector<const Product*> expected;
+                double scan = measureMs([&] { expected = scanProducts(stored, q); });
+                bool same = found.size() == expected.size();
+                for (size_t i = 0; same && i < found.size(); ++i) {
+                    same = found[i].getBarcode() == expected[i]->getBarcode() &&
+                        found[i].getDescription() == expected[i]->getDescription();
+                }
+                cout << "  \"" << q << "\": найдено " << found.size() << ", индекс " << indexed << " мс, просмотр "
+                     << scan << " мс" << (same ? "" : "  РАСХОЖДЕНИЕ С ЭТАЛОНОМ") << endl;
+            }
+            if (round == 0) {
+                shuffle(items.begin(), items.end(), gen);
+                double remove = measureMs([&] {
+                    for (size_t i = 0; i < n / 2; ++i) w.removeProduct(items[i].getBarcode());
+                });
+                cout << n << " SKU, удаление половины: " << remove * 2e6 / double(n) << " нс/продукт, осталось "
+                     << w.getProducts().size() << endl;
+            }
+        }
+    }
+    cout << endl;
+}
+
+// Эталон: полный перебор складов с тем же порядком (расстояние, номер)
+vector<WarehouseIndex::Hit> scanWarehouses(const vector<Warehouse>& warehouses, float lon, float lat, Metric metric,
+    size_t k, double radius, int quantity) {
+    vector<WarehouseIndex::Hit> hits;
+    for (size_t i = 0; i < warehouses.size(); ++i) {
+        double d = WarehouseIndex::distance(warehouses[i], lon, lat, metric);
+        if (d <= radius && warehouses[i].hasRoom(quantity)) hits.push_back({ i, d });
+    }
+    sort(hits.begin(), hits.end(), [](const WarehouseIndex::Hit& a, const WarehouseIndex::Hit& b) {
+        return a.distance != b.distance ? a.distance < b.distance : a.index < b.index;
+    });
+    if (hits.size() > k) hits.resize(k);
+    return hits;
+}
+
+bool sameHits(const vector<WarehouseIndex::Hit>& a, const vector<WarehouseIndex::Hit>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].index != b[i].index || a[i].distance != b[i].distance) return false;
+    }
+    return true;
+}
+
+void benchRouting() {
+    cout << "== routing ==" << endl;
+    mt19937 gen(3);
+    uniform_real_distribution<float> lonDist(19.0f, 169.0f), latDist(41.0f, 82.0f);
+    const size_t sites = 5000, queries = 200000, checked = 2000;
+
+    vector<Warehouse> warehouses;
+    for (size_t i = 0; i < sites; ++i) warehouses.emplace_back(WarehouseType::CENTER, lonDist(gen), latDist(gen), 50);
+    WarehouseIndex index;
+    double build = measureMs([&] { index.rebuild(warehouses); });
+    cout << sites << " складов, построение индекса: " << build << " мс" << endl;
+
+    vector<pair<float, float>> points(queries);
+    for (auto& point : points) point = { lonDist(gen), latDist(gen) };
+
+    const pair<Metric, const char*> metrics[] = {
+        { Metric::MANHATTAN, "manhattan" }, { Metric::EUCLIDEAN, "euclidean" }, { Metric::GREAT_CIRCLE, "great-circle" } };
+    const double radii[] = { 3.0, 2.0, 200.0 };
+    for (size_t m = 0; m < 3; ++m) {
+        Metric metric = metrics[m].first;
+        size_t sum = 0;
+        double nearest = measureMs([&] {
+            for (const auto& point : points) sum += index.nearest(point.first, point.second, metric).index;
+        });
+        double knn = measureMs([&] {
+            for (const auto& point : points) sum += index.kNearest(point.first, point.second, metric, 8).size();
+        });
+        size_t inRadius = 0;
+        double radius = measureMs([&] {
+            for (const auto& point : points) inRadius += index.withinRadius(point.first, point.second, metric, radii[m]).size();
+        });
+        // Исходный способ из menu(): линейный поиск минимума
+        double scan = measureMs([&] {
+            for (size_t i = 0; i < checked; ++i) {
+                size_t best = 0;
+                double minDist = WarehouseIndex::distance(warehouses[0], points[i].first, points[i].second, metric);
+                for (size_t j = 1; j < sites; ++j) {
+                    double dist = WarehouseIndex::distance(warehouses[j], points[i].first, points[i].second, metric);
+                    if (dist < minDist) {
+                        minDist = dist;
+                        best = j;
+                    }
+                }
+                sum += best;
+            }
+        });
+        size_t mismatches = 0;
+        for (size_t i = 0; i < checked; ++i) {
+            float lon = points[i].first, lat = points[i].second;
+            double inf = numeric_limits<double>::infinity();
+            mismatches += !sameHits({ index.nearest(lon, lat, metric) }, scanWarehouses(warehouses, lon, lat, metric, 1, inf, 0));
+            mismatches += !sameHits(index.kNearest(lon, lat, metric, 8), scanWarehouses(warehouses, lon, lat, metric, 8, inf, 0));
+            mismatches += !sameHits(index.withinRadius(lon, lat, metric, radii[m]),
+                scanWarehouses(warehouses, lon, lat, metric, SIZE_MAX, radii[m], 0));
+        }
+        cout << metrics[m].second << ": ближайший " << nearest * 1e6 / double(queries) << " нс, 8 ближайших "
+             << knn * 1e6 / double(queries) << " нс, радиус " << radii[m] << " (в среднем " << double(inRadius) / double(queries)
+             << ") " << radius * 1e6 / double(queries) << " нс; перебор " << scan * 1e6 / double(checked)
+             << " нс; расхождений с перебором " << mismatches << (sum == 0 ? " " : "") << endl;
+    }
+
+    // 1000 складов по 50 единиц заполняются до отказа: каждый следующий продукт
+    // уходит на ближайший склад с местом; эталон - тот же выбор полным перебором
+    const size_t small = 1000, products = 60000;
+    vector<Warehouse> filled(warehouses.begin(), warehouses.begin() + small);
+    vector<Warehouse> reference = filled;
+    index.rebuild(filled);
+    size_t placed = 0, mismatches = 0;
+    double route = measureMs([&] {
+        for (size_t i = 0; i < products; ++i) {
+            Product p("груз", 1.0f, 1 + int(i % 3), points[i].first, points[i].second);
+            placed += index.route(filled, p, Metric::GREAT_CIRCLE) != WarehouseIndex::notFound;
+        }
+    });
+    for (size_t i = 0; i < products; ++i) {
+        int quantity = 1 + int(i % 3);
+        vector<WarehouseIndex::Hit> expected = scanWarehouses(reference, points[i].first, points[i].second,
+            Metric::GREAT_CIRCLE, 1, numeric_limits<double>::infinity(), quantity);
+        if (!expected.empty()) reference[expected[0].index].updateStock(quantity);
+    }
+    for (size_t i = 0; i < small; ++i) mismatches += reference[i].getTotalStock() != filled[i].getTotalStock();
+    cout << "размещение с переполнением: " << route * 1e6 / double(products) << " нс/продукт, размещено " << placed
+         << " из " << products << ", расхождений запаса с перебором " << mismatches << endl;
+    cout << endl;
+}
+
+void benchIngest() {
+    cout << "== ingest ==" << endl;
+    mt19937 gen(4);
+    uniform_real_distribution<float> lonDist(19.0f, 169.0f), latDist(41.0f, 82.0f);
+    const size_t sites = 5000, n = 1000000;
+
+    vector<Warehouse> base;
+    for (size_t i = 0; i < sites; ++i) base.emplace_back(WarehouseType::CENTER, lonDist(gen), latDist(gen), 360);
+    WarehouseIndex index(base);
+
+    vector<Product> items = describedProducts(n, gen);
+    for (Product& p : items) {
+        p.setQuantity(1 + int(gen() % 3));
+        p.setTransportLong(lonDist(gen));
+        p.setTransportLat(latDist(gen));
+    }
+    const string csvPath = "prod_ware_bench.csv", binPath = "prod_ware_bench.bin";
+    double write = measureMs([&] {
+        ofstream out(csvPath);
+        out << "# описание;цена;количество;долгота;широта;штрих-код\n";
+        for (size_t i = 0; i < items.size(); ++i) {
+            const Product& p = items[i];
+            out << '"' << p.getDescription() << "\";" << p.getPrice() << ';' << p.getQuantity() << ';'
+                << setprecision(9) << p.getTransportLong() << ';' << p.getTransportLat() << ';' << p.getBarcode() << '\n';
+            if (i % 100000 == 0) out << "битая строка\n" << "\"товар\";1;-5;50;50;\n";
+        }
+        writeProductsBinary(binPath, items);
+    });
+    cout << n << " продуктов, запись CSV и .bin: " << write << " мс" << endl;
+
+    for (const string& path : { csvPath, binPath }) {
+        vector<Warehouse> warehouses = base;
+        ProductBatch batch;
+        double read = measureMs([&] {
+            if (path == binPath) readProductsBinary(path, batch);
+            else readProductsCsv(path, batch);
+        });
+        IngestReport report;
+        double assign = measureMs([&] { report = ingestProducts(warehouses, index, move(batch), Metric::GREAT_CIRCLE); });
+        cout << path << ": чтение " << read << " мс, размещение " << assign << " мс; принято " << report.accepted << " ("
+             << report.units << " ед.), отклонено " << report.rejected.size();
+        if (!report.rejected.empty()) cout << ", первое: запись " << report.rejected[0].record << " - " << report.rejected[0].reason;
+        cout << endl;
+    }
+
+    // Поштучно, как из меню: маршрутизация и копирование каждого продукта
+    vector<Warehouse> bulk = base, single = base;
+    ProductBatch batch;
+    readProductsBinary(binPath, batch);
+    double oneByOne = measureMs([&] {
+        for (const Product& p : batch.products) index.route(single, p, Metric::GREAT_CIRCLE);
+    });
+    double together = measureMs([&] { ingestProducts(bulk, index, move(batch), Metric::GREAT_CIRCLE); });
+    size_t mismatches = 0;
+    for (size_t i = 0; i < sites; ++i) {
+        mismatches += bulk[i].getTotalStock() != single[i].getTotalStock() ||
+            bulk[i].getProducts().size() != single[i].getProducts().size();
+    }
+    cout << "поштучно " << oneByOne << " мс, пакетом " << together << " мс; расхождений складов " << mismatches << endl;
+    remove(csvPath.c_str());
+    remove(binPath.c_str());
+    cout << endl;
+}
+
+void benchColumns() {
+    cout << "== columns ==" << endl;
+    mt19937 gen(5);
+    const size_t n = 2000000, catalog = 100000;
+    // Записи о партиях: описания повторяются из каталога, штрих-коды свои
+    vector<Product> items = describedProducts(catalog, gen);
+    items.reserve(n);
+    for (size_t i = catalog; i < n; ++i) {
+        items.push_back(items[gen() % catalog]);
+        items.back().generateBarcode();
+    }
+    for (Product& p : items) {
+        p.setPrice(float(gen() % 100000) / 100.0f);
+        p.setQuantity(1 + int(gen() % 20));
+    }
+
+    Warehouse objects(WarehouseType::CENTER, 55.75f, 37.62f, numeric_limits<int>::max(), Storage::OBJECTS);
+    Warehouse columns(WarehouseType::CENTER, 55.75f, 37.62f, numeric_limits<int>::max(), Storage::COLUMNS);
+    for (Warehouse* w : { &objects, &columns }) {
+        const char* name = w == &objects ? "объекты" : "колонки";
+        double add = measureMs([&] {
+            for (const Product& p : items) w->addProduct(p);
+        });
+        double value = 0;
+        double total = measureMs([&] { value = w->totalValue(); });
+        size_t filtered = 0;
+        double filter = measureMs([&] { filtered = w->filterByPrice(100.0f, 120.0f).size(); });
+        size_t found = 0;
+        double search = measureMs([&] { found = w->findProduct("молоток Заря").size() + w->findProduct("4242").size(); });
+        size_t hits = 0;
+        double lookup = measureMs([&] {
+            for (size_t i = 0; i < n; i += 10) hits += bool(w->findByBarcode(items[i].getBarcode()));
+        });
+        double remove = measureMs([&] {
+            for (size_t i = 0; i < n; i += 10) w->removeProduct(items[i].getBarcode());
+        });
+        cout << name << ": " << double(w->memoryBytes()) / double(n) << " байт/SKU; добавление " << add * 1e6 / double(n)
+             << " нс, стоимость запаса " << total << " мс (" << llround(value) << "), фильтр по цене " << filter << " мс (" << filtered << "), поиск описаний " << search
+             << " мс (" << found << "), штрих-код " << lookup * 1e7 / double(n) << " нс (" << hits << "), удаление "
+             << remove * 1e7 / double(n) << " нс" << endl;
+    }
+
+    // Склады после одинаковых операций должны совпадать продукт в продукт
+    bool same = objects.productCount() == columns.productCount() && objects.getTotalStock() == columns.getTotalStock();
+    vector<Product> a = objects.getProducts(), b = columns.getProducts();
+    for (size_t i = 0; same && i < a.size(); ++i) {
+        same = a[i].getBarcode() == b[i].getBarcode() && a[i].getDescription() == b[i].getDescription() &&
+            a[i].getPrice() == b[i].getPrice() && a[i].getQuantity() == b[i].getQuantity() &&
+            a[i].getTransportLong() == b[i].getTransportLong() && a[i].getTransportLat() == b[i].getTransportLat();
+    }
+    vector<ProductRef> fa = objects.findProduct("ый ша"), fb = columns.findProduct("ый ша");
+    same = same && fa.size() == fb.size();
+    for (size_t i = 0; same && i < fa.size(); ++i) same = fa[i].getSlot() == fb[i].getSlot();
+    cout << "содержимое складов " << (same ? "совпадает" : "РАСХОДИТСЯ") << endl;
+    cout << endl;
+}
+
+// Смесь операций одного потока: 70% поиск по штрих-коду, 15% добавление нового
+// продукта, 15% удаление одного из своих добавленных
+template <typename Find, typename Add, typename Remove>
+void mixedOperations(size_t operations, const vector<string>& known, Find find, Add add, Remove remove) {
+    mt19937& gen = threadRandom();
+    vector<string> own;
+    for (size_t i = 0; i < operations; ++i) {
+        unsigned dice = gen() % 100;
+        if (dice < 70 || (dice >= 85 && own.empty())) {
+            find(known[gen() % known.size()]);
+        }
+        else if (dice < 85) {
+            Product p(ConcurrentWarehouse::newBarcode(), "партия", 10.0f, 1, 50.0f, 50.0f);
+            if (add(p)) own.push_back(p.getBarcode());
+        }
+        else {
+            size_t k = gen() % own.size();
+            remove(own[k]);
+            own[k] = move(own.back());
+            own.pop_back();
+        }
+    }
+}
+
+void benchConcurrent() {
+    cout << "== concurrent ==" << endl;
+    const size_t preload = 200000, operations = 400000;
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    cout << "ядер: " << cores << endl;
+    vector<Product> items = randomProducts(preload);
+    vector<string> known;
+    for (const Product& p : items) known.push_back(p.getBarcode());
+
+    for (unsigned threads : {1u, 2u, 4u, 8u}) {
+        // Сегодняшний способ: один Warehouse под одним замком
+        Warehouse single(WarehouseType::CENTER, 55.75f, 37.62f, numeric_limits<int>::max());
+        for (const Product& p : items) single.addProduct(p);
+        mutex lock;
+        double locked = measureMs([&] {
+            vector<thread> workers;
+            for (unsigned t = 0; t < threads; ++t) {
+                workers.emplace_back([&] {
+                    mixedOperations(operations / threads, known,
+                        [&](const string& b) { lock_guard<mutex> g(lock); return bool(single.findByBarcode(b)); },
+                        [&](const Product& p) { lock_guard<mutex> g(lock); return single.addProduct(p); },
+                        [&](const string& b) { lock_guard<mutex> g(lock); return single.removeProduct(b); });
+                });
+            }
+            for (thread& w : workers) w.join();
+        });
+
+        ConcurrentWarehouse sharded(WarehouseType::CENTER, 55.75f, 37.62f, numeric_limits<int>::max(), 16);
+        for (const Product& p : items) sharded.addProduct(p);
+        double concurrent = measureMs([&] {
+            vector<thread> workers;
+            for (unsigned t = 0; t < threads; ++t) {
+                workers.emplace_back([&] {
+                    mixedOperations(operations / threads, known,
+                        [&](const string& b) { return sharded.withProduct(b, [](const ProductRef& p) { return p.getQuantity(); }); },
+                        [&](const Product& p) { return sharded.addProduct(p); },
+                        [&](const string& b) { return sharded.removeProduct(b); });
+                });
+            }
+            for (thread& w : workers) w.join();
+        });
+        cout << threads << " потоков: один замок " << double(operations) / locked / 1e3 << " млн оп/с, шарды "
+             << double(operations) / concurrent / 1e3 << " млн оп/с; запас " << sharded.getTotalStock() << " = "
+             << sharded.shardStock() << ", продуктов " << sharded.productCount() << endl;
+    }
+
+    // Гонка за вместимость: потоки добавляют больше, чем помещается
+    const int capacity = 100000;
+    ConcurrentWarehouse limited(WarehouseType::CENTER, 55.75f, 37.62f, capacity, 16);
+    atomic<long long> accepted(0);
+    vector<thread> workers;
+    for (unsigned t = 0; t < 8; ++t) {
+        workers.emplace_back([&] {
+            for (int i = 0; i < capacity / 4; ++i) {
+                Product p(ConcurrentWarehouse::newBarcode(), "груз", 1.0f, 1 + i % 3, 50.0f, 50.0f);
+                if (limited.addProduct(p)) accepted += p.getQuantity();
+            }
+        });
+    }
+    for (thread& w : workers) w.join();
+    cout << "вместимость " << capacity << ": принято " << accepted.load() << " ед., запас " << limited.getTotalStock()
+         << " = " << limited.shardStock() << endl;
+    cout << endl;
+}
+
+// Одинаковы ли склады слот в слот (после восстановления порядок хранения тот же)
+bool sameWarehouses(const vector<Warehouse>& a, const vector<Warehouse>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t w = 0; w < a.size(); ++w) {
+        if (a[w].productCount() != b[w].productCount() || a[w].getTotalStock() != b[w].getTotalStock()) return false;
+        for (size_t slot = 0; slot < a[w].productCount(); ++slot) {
+            ProductRef x(&a[w], slot), y(&b[w], slot);
+            if (x.getBarcode() != y.getBarcode() || x.getDescription() != y.getDescription() || x.getPrice() != y.getPrice() ||
+                x.getQuantity() != y.getQuantity() || x.getTransportLong() != y.getTransportLong() ||
+                x.getTransportLat() != y.getTransportLat()) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Три склада меню, заполненные n записями о партиях (описания из каталога)
+vector<Warehouse> filledWarehouses(size_t n, Storage storage, mt19937& gen) {
+    vector<Warehouse> warehouses;
+    warehouses.emplace_back(WarehouseType::CENTER, 55.75f, 37.62f, numeric_limits<int>::max(), storage);
+    warehouses.emplace_back(WarehouseType::WEST, 59.94f, 30.31f, numeric_limits<int>::max(), storage);
+    warehouses.emplace_back(WarehouseType::EAST, 56.83f, 60.60f, numeric_limits<int>::max(), storage);
+    vector<Product> catalog = describedProducts(100000, gen);
+    for (Warehouse& w : warehouses) w.reserve(n / warehouses.size() + 1);
+    for (size_t i = 0; i < n; ++i) {
+        Product p = catalog[gen() % catalog.size()];
+        p.generateBarcode(gen);
+        p.setPrice(float(gen() % 100000) / 100.0f);
+        p.setQuantity(1 + int(gen() % 20));
+        warehouses[i % warehouses.size()].addProduct(move(p));
+    }
+    return warehouses;
+}
+
+vector<Warehouse> emptyLike(const vector<Warehouse>& warehouses) {
+    vector<Warehouse> result;
+    for (const Warehouse& w : warehouses) {
+        auto position = w.getCoordinates();
+        result.emplace_back(w.getType(), position.first, position.second, w.getMaxCapacity(), w.getStorage());
+    }
+    return result;
+}
+
+void benchPersist() {
+    cout << "== persist ==" << endl;
+    const string base = "prod_ware_bench";
+    auto cleanup = [&] {
+        remove((base + ".snap").c_str());
+        remove((base + ".log").c_str());
+    };
+    mt19937 gen(6);
+
+    // Цена журнала на операцию добавления
+    const size_t n = 200000;
+    vector<Product> items = describedProducts(n, gen);
+    {
+        vector<Warehouse> plain = filledWarehouses(0, Storage::OBJECTS, gen);
+        double memory = measureMs([&] {
+            for (size_t i = 0; i < n; ++i) plain[i % 3].addProduct(items[i]);
+        });
+
+        cleanup();
+        vector<Warehouse> logged = emptyLike(plain);
+        WarehouseJournal journal(base);
+        WarehouseJournal::Recovery recovery;
+        journal.recover(logged, recovery);
+        double grouped = measureMs([&] {
+            for (size_t i = 0; i < n; ++i) {
+                if (logged[i % 3].addProduct(items[i])) journal.logAdd(i % 3, items[i]);
+            }
+            journal.commit();
+        });
+        size_t groupedSyncs = journal.syncCount();
+
+        // Подтверждение каждой операции по отдельности (как в меню)
+        const size_t each = 2000;
+        double oneByOne = measureMs([&] {
+            for (size_t i = 0; i < each; ++i) {
+                Product p = items[i];
+                p.generateBarcode(gen);
+                if (logged[0].addProduct(p)) journal.waitDurable(journal.logAdd(0, p));
+            }
+        });
+
+        // Потоки ждут подтверждения своих записей: одна синхронизация на многих
+        const unsigned threads = 8;
+        size_t before = journal.syncCount();
+        double parallel = measureMs([&] {
+            vector<thread> workers;
+            for (unsigned t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] {
+                    for (size_t i = 0; i < each; ++i) journal.waitDurable(journal.logUpdateStock(t % 3, 1));
+                });
+            }
+            for (thread& w : workers) w.join();
+        });
+        size_t parallelSyncs = journal.syncCount() - before;
+        cout << n << " добавлений: в памяти " << memory << " мс, с журналом " << grouped << " мс (" << groupedSyncs
+             << " fsync)" << endl;
+        cout << "подтверждение каждой: " << oneByOne * 1e3 / double(each) << " мкс/оп; " << threads << " потоков с подтверждением: "
+             << double(threads * each) / parallel << " тыс. оп/с, " << double(threads * each) / double(parallelSyncs)
+             << " записей на fsync" << endl;
+        for (unsigned t = 0; t < threads; ++t) logged[t % 3].updateStock(int(each));
+        journal.commit();
+        vector<Warehouse> replayed = emptyLike(plain);
+        WarehouseJournal again(base);
+        double replay = measureMs([&] { again.recover(replayed, recovery); });
+        cout << "воспроизведение журнала (" << recovery.replayed << " операций): " << replay << " мс, склады "
+             << (sameWarehouses(logged, replayed) ? "совпадают" : "РАСХОДЯТСЯ") << endl;
+    }
+
+    // Холодный старт: снимок + хвост журнала
+    for (auto config : { make_pair(size_t(1000000), Storage::OBJECTS), make_pair(size_t(10000000), Storage::COLUMNS) }) {
+        cleanup();
+        vector<Warehouse> warehouses = filledWarehouses(config.first, config.second, gen);
+        const char* name = config.second == Storage::OBJECTS ? "объекты" : "колонки";
+        size_t snapshotBytes = 0;
+        {
+            WarehouseJournal journal(base);
+            WarehouseJournal::Recovery recovery;
+            vector<Warehouse> none = emptyLike(warehouses);
+            journal.recover(none, recovery);
+            double write = measureMs([&] { journal.snapshot(warehouses); });
+            ifstream snap(base + ".snap", ios::binary | ios::ate);
+            snapshotBytes = size_t(snap.tellg());
+            // После снимка - еще 100000 операций в журнале
+            for (size_t i = 0; i < 100000; ++i) {
+                size_t w = i % warehouses.size();
+                if (i % 4 == 3) {
+                    string barcode = ProductRef(&warehouses[w], gen() % warehouses[w].productCount()).getBarcode();
+                    if (warehouses[w].removeProduct(barcode)) journal.logRemove(w, barcode);
+                }
+                else if (warehouses[w].addProduct(items[i])) journal.logAdd(w, items[i]);
+            }
+            journal.commit();
+            cout << name << ", " << config.first << " продуктов: снимок " << write << " мс, " << double(snapshotBytes) / double(config.first)
+                 << " байт/продукт" << endl;
+        }
+        vector<Warehouse> restored = emptyLike(warehouses);
+        WarehouseJournal::Recovery recovery;
+        double start = measureMs([&] {
+            WarehouseJournal journal(base);
+            journal.recover(restored, recovery);
+        });
+        cout << "  холодный старт " << start << " мс: из снимка " << recovery.snapshotProducts << ", из журнала "
+             << recovery.replayed << " операций; склады " << (sameWarehouses(warehouses, restored) ? "совпадают" : "РАСХОДЯТСЯ") << endl;
+    }
+    cleanup();
+    cout << endl;
+}
+
+// Эталон сводки: полный проход по копиям продуктов
+InventoryStats scanStats(const vector<Product>& products) {
+    InventoryStats result;
+    for (const Product& p : products) {
+        InventoryStats one;
+        one.products = 1;
+        one.units = p.getQuantity();
+        one.valueKopecks = valueKopecks(p.getPrice(), p.getQuantity());
+        one.minPrice = one.maxPrice = p.getPrice();
+        one.minQuantity = one.maxQuantity = p.getQuantity();
+        result.merge(one);
+    }
+    return result;
+}
+
+bool sameStats(const InventoryStats& a, const InventoryStats& b) {
+    return a.products == b.products && a.units == b.units && a.valueKopecks == b.valueKopecks && a.minPrice == b.minPrice &&
+        a.maxPrice == b.maxPrice && a.minQuantity == b.minQuantity && a.maxQuantity == b.maxQuantity;
+}
+
+void benchAggregates() {
+    cout << "== aggregates ==" << endl;
+    mt19937 gen(8);
+    const size_t n = 1000000, operations = 300000, k = 10;
+    for (Storage storage : { Storage::OBJECTS, Storage::COLUMNS }) {
+        vector<Warehouse> warehouses = filledWarehouses(n, storage, gen);
+        Warehouse& w = warehouses[0];
+        const char* name = storage == Storage::OBJECTS ? "объекты" : "колонки";
+
+        // Оборот: добавления, удаления и смена цены или количества
+        vector<string> barcodes;
+        for (size_t slot = 0; slot < w.productCount(); ++slot) barcodes.push_back(ProductRef(&w, slot).getBarcode());
+        vector<Product> items = describedProducts(operations, gen);
+        double churn = measureMs([&] {
+            for (size_t i = 0; i < operations; ++i) {
+                unsigned dice = gen() % 3;
+                if (dice == 0) {
+                    Product& p = items[i];
+                    p.setPrice(float(gen() % 100000) / 100.0f);
+                    p.setQuantity(1 + int(gen() % 20));
+                    if (w.addProduct(p)) barcodes.push_back(p.getBarcode());
+                }
+                else {
+                    size_t pick = gen() % barcodes.size();
+                    if (dice == 1) {
+                        w.removeProduct(barcodes[pick]);
+                        barcodes[pick] = move(barcodes.back());
+                        barcodes.pop_back();
+                        continue;
+                    }
+                    ProductRef found = w.findByBarcode(barcodes[pick]);
+                    if (!found) continue;
+                    Product changed = found.toProduct();
+                    if (gen() % 2) changed.setPrice(float(gen() % 200000) / 100.0f);
+                    else changed.setQuantity(1 + int(gen() % 40));
+                    w.updateProduct(barcodes[pick], changed);
+                }
+            }
+        });
+
+        InventoryStats summary;
+        vector<ProductRef> byPrice, byQuantity;
+        const size_t queries = 1000;
+        double fast = measureMs([&] {
+            for (size_t q = 0; q < queries; ++q) {
+                summary = w.stats();
+                byPrice = w.topByPrice(k);
+                byQuantity = w.topByQuantity(k);
+            }
+        });
+
+        // Как раньше: копия всех продуктов и полный проход
+        InventoryStats scanned;
+        vector<Product> copy, topPrice, topQuantity;
+        double scan = measureMs([&] {
+            copy = w.getProducts();
+            scanned = scanStats(copy);
+            topPrice = topQuantity = copy;
+            partial_sort(topPrice.begin(), topPrice.begin() + k, topPrice.end(), [](const Product& a, const Product& b) {
+                return a.getPrice() > b.getPrice();
+            });
+            partial_sort(topQuantity.begin(), topQuantity.begin() + k, topQuantity.end(), [](const Product& a, const Product& b) {
+                return a.getQuantity() > b.getQuantity();
+            });
+        });
+        bool same = sameStats(summary, scanned) && byPrice.size() == k && byQuantity.size() == k;
+        for (size_t i = 0; same && i < k; ++i) {
+            same = byPrice[i].getPrice() == topPrice[i].getPrice() && byQuantity[i].getQuantity() == topQuantity[i].getQuantity();
+        }
+        InventoryStats all = statsByType(warehouses, WarehouseType::CENTER);
+        all.merge(statsByType(warehouses, WarehouseType::WEST));
+        all.merge(statsByType(warehouses, WarehouseType::EAST));
+        InventoryStats reference;
+        for (const Warehouse& each : warehouses) reference.merge(scanStats(each.getProducts()));
+        same = same && sameStats(all, reference) && topByPrice(warehouses, 1)[0].getPrice() == reference.maxPrice;
+
+        cout << name << ": " << double(w.memoryBytes()) / double(w.productCount()) << " байт/SKU, оборот " << operations
+             << " операций " << churn * 1e6 / double(operations) << " нс/оп; сводка и топ-" << k << " "
+             << fast * 1e3 / double(queries) << " мкс, полный проход " << scan << " мс; стоимость "
+             << llround(summary.value()) << " руб., сверка "
+             << (same ? "совпадает" : "РАСХОДИТСЯ") << endl;
+    }
+    cout << endl;
+}
+
+void benchTrace();
+
+void runBenchmarks(const string& only) {
+    if (only.empty() || only == "barcode") benchBarcode();
+    if (only.empty() || only == "search") benchSearch();
+    if (only.empty() || only == "routing") benchRouting();
+    if (only.empty() || only == "ingest") benchIngest();
+    if (only.empty() || only == "columns") benchColumns();
+    if (only.empty() || only == "concurrent") benchConcurrent();
+    if (only.empty() || only == "persist") benchPersist();
+    if (only.empty() || only == "aggregates") benchAggregates();
+    if (only.empty() || only == "trace") benchTrace();
+}
+
+// ===== Воспроизведение трассы (запуск: prod_ware --replay файл | --synthetic [ключи]) =====
+
+// Гистограмма задержек, нс: до 64 - точно, дальше 32 корзины на каждую степень
+// двойки (погрешность до 3%); память не зависит от длины трассы
+class LatencyHistogram {
+private:
+    static constexpr int subBits = 5;
+    static constexpr size_t exact = 64;
+    vector<uint64_t> counts = vector<uint64_t>(exact + (64 - 6) * (size_t(1) << subBits), 0);
+    uint64_t total = 0, maximum = 0;
+    double sum = 0;
+
+    static size_t bucketOf(uint64_t ns) {
+        if (ns < exact) return size_t(ns);
+        int high = 6;
+        while (high < 63 && (ns >> (high + 1)) != 0) ++high;
+        int shift = high - subBits;
+        return exact + size_t(high - 6) * (size_t(1) << subBits) + size_t((ns >> shift) & ((1 << subBits) - 1));
+    }
+
+    // Верхняя граница корзины
+    static uint64_t limitOf(size_t bucket) {
+        if (bucket < exact) return bucket;
+        size_t step = bucket - exact;
+        int high = 6 + int(step >> subBits);
+        uint64_t sub = step & ((size_t(1) << subBits) - 1);
+        int shift = high - subBits;
+        return (((uint64_t(1) << subBits) + sub + 1) << shift) - 1;
+    }
+
+public:
+    void add(uint64_t ns) {
+        ++counts[bucketOf(ns)];
+        ++total;
+        sum += double(ns);
+        maximum = max(maximum, ns);
+    }
+
+    // Задержка, которую не превышает доля q операций
+    uint64_t percentile(double q) const {
+        uint64_t rank = uint64_t(ceil(q * double(total))), seen = 0;
+        for (size_t bucket = 0; bucket < counts.size(); ++bucket) {
+            seen += counts[bucket];
+            if (seen >= rank && seen > 0) return min(limitOf(bucket), maximum);
+        }
+        return maximum;
+    }
+
+    double mean() const {
+        return total ? sum / double(total) : 0.0;
+    }
+    uint64_t slowest() const {
+        return maximum;
+    }
+};
+
+// Счетчики операции одного вида
+struct TraceCounters {
+    size_t count = 0;
+    size_t hits = 0; // add - принят, remove/lookup - найден, find - хоть что-то, info - склад есть
+    uint64_t results = 0; // find - всего найденных продуктов
+    LatencyHistogram latency;
+};
+
+// Доли операций синтетической трассы (в сумме - любое положительное число)
+struct TraceMix {
+    unsigned add = 20, remove = 10, find = 20, lookup = 45, info = 5;
+};
+
+// "add=20,remove=10,find=20,lookup=45,info=5" - перечисленные доли заменяются
+bool parseMix(const string& text, TraceMix& mix) {
+    stringstream in(text);
+    string part;
+    while (getline(in, part, ',')) {
+        size_t eq = part.find('=');
+        int share;
+        if (eq == string::npos || !parseNumber(part.substr(eq + 1), share) || share < 0) return false;
+        string name = part.substr(0, eq);
+        if (name == "add") mix.add = share;
+        else if (name == "remove") mix.remove = share;
+        else if (name == "find") mix.find = share;
+        else if (name == "lookup") mix.lookup = share;
+        else if (name == "info") mix.info = share;
+        else return false;
+    }
+    return mix.add + mix.remove + mix.find + mix.lookup + mix.info > 0;
+}
+
+// Синтетическая трасса: preload добавлений, measure, затем operations операций
+// по долям mix. Удаляются и ищутся по штрих-коду продукты, которые должны быть на
+// складах (если вместимость не ограничена), каждый десятый поиск - мимо; пока
+// склады пусты, удаления и поиски идут мимо (выдуманный штрих-код или текст)
+vector<TraceEntry> syntheticTrace(size_t preload, size_t operations, const TraceMix& mix, mt19937& gen) {
+    uniform_real_distribution<float> lonDist(19.0f, 169.0f), latDist(41.0f, 82.0f);
+    unsigned shares[] = { mix.add, mix.remove, mix.find, mix.lookup, mix.info };
+    discrete_distribution<int> pick(begin(shares), end(shares));
+    vector<TraceEntry> trace;
+    trace.reserve(preload + operations + 1);
+    vector<string> live; // штрих-коды и описания продуктов на складах
+    vector<string> liveText;
+
+    auto add = [&] {
+        TraceEntry entry{ TraceOp::ADD, describedProducts(1, gen)[0], "", 0 };
+        Product& p = entry.product;
+        p.generateBarcode(gen);
+        p.setPrice(float(gen() % 100000) / 100.0f);
+        p.setQuantity(1 + int(gen() % 20));
+        p.setTransportLong(lonDist(gen));
+        p.setTransportLat(latDist(gen));
+        live.push_back(p.getBarcode());
+        liveText.push_back(p.getDescription());
+        trace.push_back(move(entry));
+    };
+    for (size_t i = 0; i < preload; ++i) add();
+    trace.push_back({ TraceOp::MEASURE, Product(), "", 0 });
+
+    for (size_t i = 0; i < operations; ++i) {
+        TraceOp op = TraceOp(pick(gen));
+        if (op == TraceOp::ADD) {
+            add();
+            continue;
+        }
+        TraceEntry entry{ op, Product(), "", 0 };
+        bool miss = live.empty() || gen() % 10 == 0;
+        size_t which = live.empty() ? 0 : gen() % live.size();
+        auto missingBarcode = [&] { return Product::makeBarcode([&] { return int(gen() >> 1); }); };
+        switch (op) {
+        case TraceOp::REMOVE:
+            if (live.empty()) {
+                entry.text = missingBarcode();
+                break;
+            }
+            entry.text = live[which];
+            live[which] = move(live.back());
+            live.pop_back();
+            liveText[which] = move(liveText.back());
+            liveText.pop_back();
+            break;
+        case TraceOp::FIND: {
+            // Слова описания "прилагательное существительное бренд номер": два средних или номер
+            if (miss) {
+                entry.text = "нет такого товара";
+                break;
+            }
+            const string& text = liveText[which];
+            size_t first = text.find(' '), last = text.rfind(' ');
+            entry.text = gen() % 2 ? text.substr(first + 1, last - first - 1) : text.substr(last + 1);
+            break;
+        }
+        case TraceOp::LOOKUP:
+            entry.text = miss ? missingBarcode() : live[which];
+            break;
+        default:
+            entry.warehouse = int(gen() % 4);
+            break;
+        }
+        trace.push_back(move(entry));
+    }
+    return trace;
+}
+
+// Пиковая резидентная память процесса, КБ (0 - неизвестна)
+size_t peakMemoryKb() {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return size_t(usage.ru_maxrss) / 1024;
+#else
+    return size_t(usage.ru_maxrss);
+#endif
+#endif
+}
+
+// Воспроизведение трассы на складах меню (вместимость capacity каждому) и отчет.
+// Контрольная сумма зависит только от результатов операций - по ней видно, что
+// изменение кода не поменяло поведение
+void replayTrace(const vector<TraceEntry>& trace, Storage storage, int capacity) {
+    vector<Warehouse> warehouses = {
+        Warehouse(WarehouseType::CENTER, 55.75, 37.62, capacity, storage),
+        Warehouse(WarehouseType::WEST, 59.94, 30.31, capacity, storage),
+        Warehouse(WarehouseType::EAST, 56.83, 60.60, capacity, storage)
+    };
+    WarehouseIndex warehouseIndex(warehouses);
+    const size_t kinds = size(traceOpNames) - 1;
+    vector<TraceCounters> counters(kinds);
+    uint64_t checksum = 1469598103934665603ull;
+    auto mix = [&](uint64_t value) {
+        checksum = (checksum ^ value) * 1099511628211ull;
+    };
+    size_t peakBefore = peakMemoryKb(), warmup = 0;
+    auto start = chrono::steady_clock::now();
+
+    for (const TraceEntry& entry : trace) {
+        if (entry.op == TraceOp::MEASURE) {
+            warmup += accumulate(counters.begin(), counters.end(), size_t(0), [](size_t n, const TraceCounters& c) { return n + c.count; });
+            counters.assign(kinds, TraceCounters());
+            start = chrono::steady_clock::now();
+            continue;
+        }
+        bool hit = false;
+        uint64_t results = 0;
+        auto begin = chrono::steady_clock::now();
+        switch (entry.op) {
+        case TraceOp::ADD: {
+            size_t best = warehouseIndex.route(warehouses, entry.product, Metric::MANHATTAN);
+            hit = best != WarehouseIndex::notFound;
+            results = best;
+            break;
+        }
+        case TraceOp::REMOVE:
+            for (size_t w = 0; w < warehouses.size() && !hit; ++w) {
+                if (entry.warehouse == 0 || size_t(entry.warehouse) == w + 1) hit = warehouses[w].removeProduct(entry.text);
+            }
+            break;
+        case TraceOp::FIND:
+            for (const Warehouse& w : warehouses) results += w.findProduct(entry.text).size();
+            hit = results > 0;
+            break;
+        case TraceOp::LOOKUP:
+            for (const Warehouse& w : warehouses) {
+                ProductRef found = w.findByBarcode(entry.text);
+                if (found) {
+                    hit = true;
+                    results = uint64_t(found.getQuantity());
+                    break;
+                }
+            }
+            break;
+        case TraceOp::INFO:
+            for (size_t w = 0; w < warehouses.size(); ++w) {
+                if (entry.warehouse != 0 && size_t(entry.warehouse) != w + 1) continue;
+                InventoryStats summary = warehouses[w].stats();
+                results += uint64_t(summary.valueKopecks) + summary.products + uint64_t(warehouses[w].getTotalStock());
+                hit = true;
+            }
+            break;
+        case TraceOp::MEASURE:
+            break;
+        }
+        auto end = chrono::steady_clock::now();
+        TraceCounters& c = counters[size_t(entry.op)];
+        ++c.count;
+        c.hits += hit;
+        c.results += results;
+        c.latency.add(uint64_t(chrono::duration_cast<chrono::nanoseconds>(end - begin).count()));
+        mix(uint64_t(entry.op) << 1 | uint64_t(hit));
+        mix(results);
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    size_t measured = 0;
+    for (const TraceCounters& c : counters) measured += c.count;
+    cout << "Склады: " << (storage == Storage::COLUMNS ? "колонки" : "объекты") << ", операций " << measured;
+    if (warmup) cout << " (подготовка " << warmup << ")";
+    cout << endl << "Время " << fixed << setprecision(1) << ms << " мс, " << setprecision(0)
+         << (ms > 0 ? double(measured) / ms * 1000.0 : 0.0) << " оп/с" << endl;
+    // Заголовок по ширине в символах (setw считает байты UTF-8)
+    auto column = [](const string& title, size_t width) {
+        size_t chars = count_if(title.begin(), title.end(), [](char c) { return (c & 0xC0) != 0x80; });
+        return string(width > chars ? width - chars : 0, ' ') + title;
+    };
+    cout << "опер.   " << column("число", 10) << column("успешно", 10) << column("найдено", 12) << column("средн.", 10)
+         << column("p50", 9) << column("p90", 9) << column("p99", 9) << column("p99.9", 10) << column("макс, мкс", 11) << endl;
+    for (size_t kind = 0; kind < kinds; ++kind) {
+        const TraceCounters& c = counters[kind];
+        if (!c.count) continue;
+        auto us = [](double ns) { return ns / 1000.0; };
+        cout << left << setw(8) << traceOpNames[kind] << right << setw(10) << c.count << setw(10) << c.hits << setw(12)
+             << (TraceOp(kind) == TraceOp::FIND ? to_string(c.results) : "-") << setprecision(2) << setw(10)
+             << us(c.latency.mean()) << setw(9) << us(double(c.latency.percentile(0.5))) << setw(9)
+             << us(double(c.latency.percentile(0.9))) << setw(9) << us(double(c.latency.percentile(0.99))) << setw(10)
+             << us(double(c.latency.percentile(0.999))) << setw(11) << us(double(c.latency.slowest())) << endl;
+    }
+    size_t warehouseBytes = 0, products = 0;
+    for (const Warehouse& w : warehouses) {
+        warehouseBytes += w.memoryBytes();
+        products += w.productCount();
+    }
+    cout << setprecision(1) << "Продуктов на складах: " << products << ", память складов " << double(warehouseBytes) / 1048576.0
+         << " МБ" << endl;
+    if (peakMemoryKb()) {
+        cout << "Пик памяти процесса: " << double(peakMemoryKb()) / 1024.0 << " МБ (до воспроизведения "
+             << double(peakBefore) / 1024.0 << " МБ)" << endl;
+    }
+    cout << "Контрольная сумма результатов: " << hex << checksum << dec << endl;
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+// Одна и та же синтетическая трасса на обоих способах хранения: контрольные суммы
+// должны совпасть
+void benchTrace() {
+    cout << "== trace ==" << endl;
+    mt19937 gen(9);
+    TraceMix mix;
+    vector<TraceEntry> trace = syntheticTrace(50000, 100000, mix, gen);
+    replayTrace(trace, Storage::OBJECTS, numeric_limits<int>::max());
+    replayTrace(trace, Storage::COLUMNS, numeric_limits<int>::max());
+    cout << endl;
+}
+
+// Ключи: --replay файл | --synthetic [--ops N] [--preload N] [--mix add=..,remove=..,find=..,lookup=..,info=..]
+//        [--seed N] [--save файл]; общие: [--storage objects|columns] [--capacity N]
+int runTrace(int argc, char* argv[]) {
+    string replayPath, savePath;
+    bool synthetic = false;
+    size_t operations = 200000, preload = 100000;
+    unsigned seed = 1;
+    TraceMix mix;
+    Storage storage = Storage::OBJECTS;
+    int capacity = numeric_limits<int>::max();
+    for (int i = 1; i < argc; ++i) {
+        string key = argv[i];
+        bool hasValue = i + 1 < argc;
+        string value = hasValue ? argv[i + 1] : "";
+        int number = 0;
+        if (key == "--synthetic") {
+            synthetic = true;
+            continue;
+        }
+        if (!hasValue) {
+            cerr << "Нет значения для " << key << endl;
+            return 1;
+        }
+        ++i;
+        bool ok = true;
+        if (key == "--replay") replayPath = value;
+        else if (key == "--save") savePath = value;
+        else if (key == "--ops" || key == "--preload" || key == "--seed") {
+            ok = parseNumber(value, number) && number >= 0;
+            if (key == "--ops") operations = size_t(number);
+            else if (key == "--preload") preload = size_t(number);
+            else seed = unsigned(number);
+        }
+        else if (key == "--capacity") ok = parseNumber(value, capacity) && capacity > 0;
+        else if (key == "--mix") ok = parseMix(value, mix);
+        else if (key == "--storage") {
+            ok = value == "objects" || value == "columns";
+            storage = value == "columns" ? Storage::COLUMNS : Storage::OBJECTS;
+        }
+        else ok = false;
+        if (!ok) {
+            cerr << "Неверный ключ или значение: " << key << " " << value << endl;
+            return 1;
+        }
+    }
+
+    vector<TraceEntry> trace;
+    if (synthetic) {
+        mt19937 gen(seed);
+        double made = measureMs([&] { trace = syntheticTrace(preload, operations, mix, gen); });
+        cout << "Синтетическая трасса: " << preload + operations << " операций за " << llround(made) << " мс" << endl;
+        if (!savePath.empty() && !writeTrace(savePath, trace)) {
+            cerr << "Не удалось записать " << savePath << endl;
+            return 1;
         }
     }
+    else {
+        vector<IngestReject> rejected;
+        if (!readTrace(replayPath, trace, rejected)) {
+            cerr << "Не удалось открыть " << replayPath << endl;
+            return 1;
+        }
+        size_t marks = count_if(trace.begin(), trace.end(), [](const TraceEntry& e) { return e.op == TraceOp::MEASURE; });
+        cout << "Трасса " << replayPath << ": " << trace.size() - marks << " операций";
+        if (!rejected.empty()) cout << ", пропущено строк " << rejected.size() << " (первая - " << rejected[0].record << ")";
+        cout << endl;
+    }
+    replayTrace(trace, storage, capacity);
+    return 0;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     setlocale(LC_ALL, "rus");
     srand(time(0)); // Инициализация генератора случайных чисел
-    menu();
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        srand(1);
+        runBenchmarks(argc > 2 ? argv[2] : "");
+        return 0;
+    }
+    if (argc > 1 && (string(argv[1]) == "--replay" || string(argv[1]) == "--synthetic")) {
+        srand(1);
+        return runTrace(argc, argv);
+    }
+    // --record файл: операции меню пишутся в трассу для --replay
+    if (argc > 2 && string(argv[1]) == "--record") {
+        ofstream trace(argv[2], ios::app);
+        if (!trace) {
+            cerr << "Не удалось открыть " << argv[2] << endl;
+            return 1;
+        }
+        menu(&trace);
+        return 0;
+    }
+    menu(nullptr);
     return 0;
 }